@@ -0,0 +1,132 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Measures the memory and CPU that cancellation reclaims under a timeout-heavy load. Every request races a short task
+// against a timeout (TaskTimerSource::after mapped to a fallback value) with when_any, the task always wins, hence the
+// timeout is left behind in the timing wheel. The load is run twice, each in a process of its own:
+//  - abandon, the timeout is simply dropped. Its timer, value source, cell and continuation stay in the wheel until the
+//    timeout expires, only then does the poll thread release them (running the stale continuation along the way)
+//  - cancel, each request owns a CancellationSource that is cancelled once the request has resolved, the timer is
+//    removed from the wheel straight away
+// Reports the resident memory still held once every request has resolved, the CPU time the process spends over the
+// window in which the timeouts expire and the number of stale timeout continuations that ran. Then 1MB aio reads are
+// abandoned / cancelled straight after being queued, an abandoned read is still carried out (into a buffer nobody
+// reads) while a cancelled read that aio has not yet started is never carried out, reports the reads carried out and
+// the CPU time spent until every read has resolved.
+//      cancellation_benchmark [n_requests = 200000] [timeout_ms = 2000] [n_reads = 256]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+#include "measure.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t batch_size = 1000;
+constexpr size_t read_size = 1 << 20;
+
+auto run_timeouts(bool cancel, size_t n_requests, std::chrono::milliseconds timeout) -> void {
+    auto factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+    auto timers = factory.timer_source();
+    auto stale_timeouts = std::atomic<size_t>(0);
+
+    // warm up the arenas and the wheel's entries so that the baseline includes them
+    static_cast<void>(timers.after(std::chrono::milliseconds(1)).block());
+    auto rss_before = resident_mb();
+    auto cpu_before = cpu_time();
+    auto start = Clock::now();
+
+    for (size_t issued = 0; issued < n_requests; issued += batch_size) {
+        auto sources = std::vector<Async::CancellationSource>(batch_size);
+        auto requests = std::vector<Async::Task<int>>();
+        for (size_t i = 0; i < batch_size; i++) {
+            auto token = cancel ? sources[i].token() : Async::CancellationToken();
+            auto work = factory.create<int>([i]() { return static_cast<int>(i); });
+            auto deadline = timers.after(timeout, token).map<int>([&stale_timeouts](Async::Unit) {
+                stale_timeouts.fetch_add(1, std::memory_order_relaxed);
+                return -1;
+            });
+
+            requests.push_back(factory.when_any<int>({ work, deadline }));
+        }
+
+        for (size_t i = 0; i < batch_size; i++) {
+            static_cast<void>(requests[i].block());
+            if (cancel) { sources[i].cancel(); }
+        }
+    }
+
+    auto issue_seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    auto issue_cpu = cpu_time() - cpu_before;
+    auto rss_held = resident_mb() - rss_before;
+
+    // wait out every timeout, the window starts once the requests have resolved
+    auto expiry_cpu_before = cpu_time();
+    std::this_thread::sleep_for(timeout + std::chrono::milliseconds(500));
+    auto expiry_cpu = cpu_time() - expiry_cpu_before;
+
+    std::cout << std::left << std::setw(8) << (cancel ? "cancel" : "abandon") << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << static_cast<double>(n_requests) / issue_seconds << " req/s"
+              << std::setw(10) << std::chrono::duration<double, std::milli>(issue_cpu).count() << "ms cpu"
+              << std::setw(10) << rss_held << "MB held"
+              << std::setw(10) << std::chrono::duration<double, std::milli>(expiry_cpu).count() << "ms cpu at expiry"
+              << std::setw(10) << stale_timeouts.load() << " stale timeouts\n";
+}
+
+auto run_reads(bool cancel, size_t n_reads) -> void {
+    auto factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+    auto io = factory.io_source();
+
+    auto* file = std::tmpfile();
+    auto contents = std::vector<char>(read_size, 'x');
+    std::fwrite(contents.data(), 1, contents.size(), file);
+    std::fflush(file);
+
+    auto completed = std::atomic<size_t>(0);
+    auto cpu_before = cpu_time();
+    auto reads = std::vector<Async::Task<int>>();
+    for (size_t i = 0; i < n_reads; i++) {
+        auto source = Async::CancellationSource();
+        auto token = cancel ? source.token() : Async::CancellationToken();
+        reads.push_back(io.read(file, IO::ReadRequest(IO::Size(read_size), IO::Offset(0)), token).map<int>([&completed](IO::ReadRequest) {
+            completed.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }));
+
+        source.cancel();
+    }
+
+    for (auto& read : reads) { static_cast<void>(read.block()); }
+
+    // a read that aio was already servicing cannot be cancelled, it is discarded once it completes
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    auto read_cpu = cpu_time() - cpu_before;
+    std::fclose(file);
+
+    std::cout << std::left << std::setw(8) << (cancel ? "cancel" : "abandon") << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << completed.load() << " / " << n_reads << " reads carried out"
+              << std::setw(10) << std::chrono::duration<double, std::milli>(read_cpu).count() << "ms cpu\n";
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_requests = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 200000u;
+    auto timeout = std::chrono::milliseconds(argc > 2 ? std::stoi(argv[2]) : 2000);
+    auto n_reads = argc > 3 ? static_cast<size_t>(std::stoul(argv[3])) : 256u;
+
+    std::cout << n_requests << " requests, each racing a task against a " << timeout.count() << "ms timeout\n";
+    run_isolated([&]() { run_timeouts(/* cancel = */ false, n_requests, timeout); });
+    run_isolated([&]() { run_timeouts(/* cancel = */ true, n_requests, timeout); });
+
+    std::cout << n_reads << " reads of " << read_size / 1024 << "KB, dropped straight after being queued\n";
+    run_isolated([&]() { run_reads(/* cancel = */ false, n_reads); });
+    run_isolated([&]() { run_reads(/* cancel = */ true, n_reads); });
+}
+
+// NOLINTEND
@@ -0,0 +1,91 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Compares a sequential pipeline of 10 dependent steps written with bind against the same pipeline written as a
+// coroutine that co_awaits each step. Each step is measured in two flavours:
+//  - queued, every step is a task created with TaskFactory::create and so is queued onto the workers
+//  - resolved, every step is a task that has already resolved (ie. a cache hit), co_await carries straight on
+// Reports the median and p99 latency of a pipeline run one at a time and the throughput of a batch run concurrently.
+//      coroutine_benchmark [n_pipelines = 20000] [batch_size = 1000]
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "async_lib/coroutine.h"
+#include "async_lib/task_factory.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int n_steps = 10;
+
+auto queued_step(Async::TaskFactory& factory, int value) -> Async::Task<int> {
+    return factory.create<int>([value]() { return value + 1; });
+}
+
+auto resolved_step(Async::TaskFactory& factory, int value) -> Async::Task<int> {
+    auto source = factory.value_source<int>();
+    source.complete(value + 1);
+    return source.create();
+}
+
+template <auto Step>
+auto bind_pipeline(Async::TaskFactory& factory, int value) -> Async::Task<int> {
+    auto task = Step(factory, value);
+    for (int i = 1; i < n_steps; i++) {
+        task = task.template bind<int>([&factory](int value) { return Step(factory, value); });
+    }
+
+    return task;
+}
+
+template <auto Step>
+auto coroutine_pipeline(Async::TaskFactory& factory, int value) -> Async::Task<int> {
+    for (int i = 0; i < n_steps; i++) {
+        value = co_await Step(factory, value);
+    }
+
+    co_return value;
+}
+
+template <typename Pipeline>
+auto measure(const std::string& name, Async::TaskFactory& factory, size_t n_pipelines, size_t batch_size, Pipeline pipeline) -> void {
+    auto latencies = std::vector<double>();
+    for (size_t i = 0; i < n_pipelines; i++) {
+        auto start = Clock::now();
+        auto result = std::get<int>(pipeline(factory, 0).block());
+        latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        if (result != n_steps) { std::cout << name << ": unexpected result " << result << "\n"; }
+    }
+
+    auto start = Clock::now();
+    for (size_t round = 0; round < n_pipelines / batch_size; round++) {
+        auto batch = std::vector<Async::Task<int>>();
+        for (size_t i = 0; i < batch_size; i++) { batch.push_back(pipeline(factory, 0)); }
+        for (auto& task : batch) { static_cast<void>(task.block()); }
+    }
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::ranges::sort(latencies);
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(2)
+              << " latency median " << std::setw(8) << latencies[latencies.size() / 2] << "us"
+              << " p99 " << std::setw(8) << latencies[latencies.size() * 99 / 100] << "us"
+              << ", throughput " << std::setw(10) << static_cast<double>(n_pipelines / batch_size * batch_size) / seconds << " pipelines/s\n";
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_pipelines = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 20000u;
+    auto batch_size = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 1000u;
+
+    auto factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+    std::cout << n_steps << " step pipelines\n";
+    measure("bind (queued)", factory, n_pipelines, batch_size, bind_pipeline<queued_step>);
+    measure("co_await (queued)", factory, n_pipelines, batch_size, coroutine_pipeline<queued_step>);
+    measure("bind (resolved)", factory, n_pipelines, batch_size, bind_pipeline<resolved_step>);
+    measure("co_await (resolved)", factory, n_pipelines, batch_size, coroutine_pipeline<resolved_step>);
+}
+
+// NOLINTEND
@@ -0,0 +1,82 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the scheduler and is not a part of the library itself.
+//
+// Measures how a pool copes with bursty arrival of jobs that block (as a job calling Task::block does). Every 100ms a
+// burst of jobs is queued, each job sleeps for 500us. Three pools are compared:
+//  - "fixed min", n_workers workers
+//  - "fixed max", max_workers workers
+//  - "elastic", n_workers workers growing up to max_workers, idle workers retire after 50ms
+// For each pool the time from a burst being queued to its last job finishing is reported along with the number of
+// running workers at the end of a burst and after the quiet period that follows it.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scheduler/worker_pool.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct BurstResult {
+    std::vector<int64_t> burst_micros;
+    unsigned int peak_workers = 0;
+    unsigned int quiet_workers = 0;
+};
+
+auto percentile(std::vector<int64_t> samples, double p) -> int64_t {
+    std::ranges::sort(samples);
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))];
+}
+
+auto run(const Scheduler::SchedulerConfig& config, unsigned int n_bursts, unsigned int jobs_per_burst) -> BurstResult {
+    auto pool = Scheduler::WorkerPool(config);
+    auto result = BurstResult {};
+
+    for (unsigned int burst = 0; burst < n_bursts; burst++) {
+        auto remaining = std::atomic<unsigned int>(jobs_per_burst);
+        auto start = Clock::now();
+        for (unsigned int i = 0; i < jobs_per_burst; i++) {
+            pool.queue(Scheduler::Context::empty(), [&remaining](Scheduler::Context) {
+                std::this_thread::sleep_for(std::chrono::microseconds(500));
+                remaining.fetch_sub(1, std::memory_order_release);
+            });
+        }
+
+        while (remaining.load(std::memory_order_acquire) > 0) { std::this_thread::sleep_for(std::chrono::microseconds(50)); }
+        result.burst_micros.push_back(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+        result.peak_workers = std::max(result.peak_workers, pool.active_workers());
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        result.quiet_workers = pool.active_workers();
+    }
+
+    return result;
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_bursts = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 20u;
+    auto jobs_per_burst = argc > 2 ? static_cast<unsigned int>(std::stoul(argv[2])) : 256u;
+    auto min_workers = argc > 3 ? static_cast<unsigned int>(std::stoul(argv[3])) : 2u;
+    auto max_workers = argc > 4 ? static_cast<unsigned int>(std::stoul(argv[4])) : 32u;
+
+    auto configs = std::vector<std::pair<std::string, Scheduler::SchedulerConfig>> {
+        { "fixed min", { .n_workers = min_workers } },
+        { "fixed max", { .n_workers = max_workers } },
+        { "elastic  ", { .n_workers = min_workers, .max_workers = max_workers, .idle_worker_timeout = std::chrono::milliseconds(50) } },
+    };
+
+    for (const auto& [name, config] : configs) {
+        auto result = run(config, n_bursts, jobs_per_burst);
+        std::cout << name << ": burst of " << jobs_per_burst << " jobs completes in"
+                  << " p50 " << percentile(result.burst_micros, 0.50) << "us"
+                  << " p90 " << percentile(result.burst_micros, 0.90) << "us"
+                  << ", workers running: peak " << result.peak_workers << " quiet " << result.quiet_workers << '\n';
+    }
+}
+
+// NOLINTEND
@@ -0,0 +1,115 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Measures how long timer expiries and externally created tasks wait while every worker is saturated by self-replenishing
+// continuation chains (each job of a chain spins for 20us and then creates the next job from within itself, hence the
+// chains never leave their worker's local queue). Meanwhile the main thread:
+//  - starts a 2ms timer (TaskTimerSource::after) every millisecond and records how late each timer's map runs
+//  - creates a task every millisecond (which lands on the global queue) and records how long it takes to start
+// The timing wheel has a 50ms tick hence timers are up to a tick late even when the workers are idle, the benchmark
+// first measures with idle workers to give the baseline.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Samples {
+    std::mutex lock;
+    std::vector<int64_t> micros;
+
+    auto record(Clock::time_point expected) -> void {
+        auto late = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - expected).count();
+        auto guard = std::lock_guard(lock);
+        micros.push_back(late);
+    }
+
+    auto count() -> size_t {
+        auto guard = std::lock_guard(lock);
+        return micros.size();
+    }
+};
+
+auto spin_for(std::chrono::nanoseconds duration) -> void {
+    auto until = Clock::now() + duration;
+    while (Clock::now() < until) {}
+}
+
+auto chain(Async::TaskFactory& factory, std::atomic<bool>& stop) -> void {
+    static_cast<void>(factory.create<int>([&factory, &stop]() {
+        spin_for(std::chrono::microseconds(20));
+        if (!stop.load(std::memory_order_relaxed)) { chain(factory, stop); }
+        return 0;
+    }));
+}
+
+auto report(const std::string& name, std::vector<int64_t> samples, size_t n_in_time, size_t n_samples) -> void {
+    std::ranges::sort(samples);
+    auto at = [&samples](double p) { return samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))]; };
+    std::cout << name << ": " << samples.size() << " samples, late by p50 " << at(0.5) << "us p90 " << at(0.9) << "us p99 "
+              << at(0.99) << "us max " << samples.back() << "us, " << n_samples - n_in_time << " still waiting 1s after the last\n";
+}
+
+// measure runs n_samples rounds with n_chains chains running on the workers
+auto measure(Async::TaskFactory& factory, size_t n_samples, unsigned int n_chains) -> void {
+    auto timer_source = factory.timer_source();
+    auto stop = std::atomic<bool>(false);
+    auto timers = Samples();
+    auto created = Samples();
+
+    // each worker picks up a chain from the global queue and then keeps it local
+    for (unsigned int i = 0; i < n_chains; i++) { chain(factory, stop); }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    auto pending = std::vector<Async::Task<int>>();
+    for (size_t i = 0; i < n_samples; i++) {
+        auto expiry = Clock::now() + std::chrono::milliseconds(2);
+        pending.push_back(timer_source.after(std::chrono::milliseconds(2)).map<int>([&timers, expiry](Async::Unit) {
+            timers.record(expiry);
+            return 0;
+        }));
+
+        pending.push_back(factory.create<int>([&created, queued_at = Clock::now()]() {
+            created.record(queued_at);
+            return 0;
+        }));
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // a starved task may never run while the chains keep going, the chains are stopped after a second's grace and the
+    // number of samples that were recorded before that point is reported
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto n_timers = timers.count();
+    auto n_created = created.count();
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& task : pending) { static_cast<void>(task.block()); }
+
+    report("  timer expiry     ", timers.micros, n_timers, n_samples);
+    report("  global task start", created.micros, n_created, n_samples);
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_workers = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 2u;
+    auto n_samples = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 500u;
+
+    auto factory = Async::TaskFactory(static_cast<int>(n_workers));
+
+    // the idle run gives the lateness inherent to the timing wheel's tick, the saturated run should add little to it
+    std::cout << "idle workers:\n";
+    measure(factory, n_samples, 0);
+    std::cout << "saturated workers (" << 2 * n_workers << " chains):\n";
+    measure(factory, n_samples, 2 * n_workers);
+}
+
+// NOLINTEND
@@ -0,0 +1,95 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the scheduler and is not a part of the library itself.
+//
+// Measures the latency from a poll source coming due to its completion job starting. A synthetic poll source comes due
+// every 500us and completes a single job. Meanwhile the workers run a stream of short bursts of work so that they are
+// regularly idle (searching) when the source comes due. Two configurations are compared:
+//  - "poll thread", every completion is polled by the poll thread and handed over via the global queue
+//  - "idle workers", searching workers poll the source and run the completion from their own queue
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "scheduler/scheduler.h"
+
+using Clock = std::chrono::steady_clock;
+
+auto spin_for(std::chrono::nanoseconds duration) -> void {
+    auto until = Clock::now() + duration;
+    while (Clock::now() < until) {}
+}
+
+class PeriodicSource : public Scheduler::IPollSource {
+public:
+    explicit PeriodicSource(std::chrono::microseconds period) : period(period), due(Clock::now() + period) {}
+
+    auto poll_frequency() -> std::chrono::milliseconds override { return std::chrono::milliseconds(1); }
+    auto next_poll() -> std::optional<TimePoint> override { return due; }
+    auto poll() -> std::vector<Scheduler::Job> override {
+        auto jobs = std::vector<Scheduler::Job>();
+        jobs.emplace_back([this, due_at = due](Scheduler::Context) {
+            auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - due_at).count();
+            auto lock = std::lock_guard(samples_lock);
+            samples.push_back(latency);
+        });
+
+        due += period;
+        return jobs;
+    }
+
+    auto take_samples() -> std::vector<int64_t> {
+        auto lock = std::lock_guard(samples_lock);
+        return std::move(samples);
+    }
+
+private:
+    std::chrono::microseconds period;
+    TimePoint due;
+    std::mutex samples_lock;
+    std::vector<int64_t> samples;
+};
+
+auto percentile(std::vector<int64_t>& samples, double p) -> double {
+    std::ranges::sort(samples);
+    auto sample = samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))];
+    return static_cast<double>(sample) / 1000.0;
+}
+
+auto run(unsigned int n_workers, bool idle_worker_polling) -> std::vector<int64_t> {
+    auto source = std::make_shared<PeriodicSource>(std::chrono::microseconds(500));
+    auto config = Scheduler::SchedulerConfig { .n_workers = n_workers, .idle_worker_polling = idle_worker_polling };
+    auto scheduler = Scheduler::Scheduler(config, { source });
+
+    // bursts of work keep the workers alternating between running and searching
+    auto until = Clock::now() + std::chrono::seconds(1);
+    while (Clock::now() < until) {
+        for (unsigned int i = 0; i < n_workers; i++) {
+            scheduler.queue(Scheduler::Context::empty(), [](Scheduler::Context) { spin_for(std::chrono::microseconds(100)); });
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(300));
+    }
+
+    return source->take_samples();
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_workers = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 4u;
+
+    for (auto idle_worker_polling : { false, true }) {
+        auto samples = run(n_workers, idle_worker_polling);
+        std::cout << (idle_worker_polling ? "idle workers" : "poll thread ") << ": " << samples.size() << " completions, due-to-start latency"
+                  << " p50 " << percentile(samples, 0.50) << "us"
+                  << " p90 " << percentile(samples, 0.90) << "us"
+                  << " p99 " << percentile(samples, 0.99) << "us\n";
+    }
+}
+
+// NOLINTEND
@@ -0,0 +1,90 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Measures the latency of a ping-pong chain of jobs, every hop of a chain creates the task for the next hop from within
+// its own job and hands it a freshly written 4KiB payload. n_chains chains bounce concurrently on a pool of n_workers.
+// With the LIFO slot the next hop runs straight after the current one on the same worker (while the payload is in
+// cache), without it the hop sits on the worker's deque where searching workers steal it away.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+
+using Clock = std::chrono::steady_clock;
+
+struct Payload {
+    std::array<uint64_t, 512> words;
+};
+
+struct Chain {
+    std::atomic<bool> done = { false };
+    size_t hops_left = 0;
+    Payload payload = {};
+};
+
+auto hop(Async::TaskFactory& factory, Chain& chain) -> void {
+    static_cast<void>(factory.create<int>([&factory, &chain]() {
+        // consume the previous hop's payload and produce the next one
+        auto sum = std::accumulate(chain.payload.words.begin(), chain.payload.words.end(), uint64_t(0));
+        for (auto& word : chain.payload.words) { word = sum++; }
+
+        chain.hops_left -= 1;
+        if (chain.hops_left == 0) {
+            chain.done.store(true, std::memory_order_release);
+        } else {
+            hop(factory, chain);
+        }
+
+        return 0;
+    }));
+}
+
+auto run(bool lifo_slot, unsigned int n_workers, size_t n_chains, size_t n_hops, size_t n_rounds) -> void {
+    auto factory = Async::TaskFactory(Scheduler::SchedulerConfig { .n_workers = n_workers, .lifo_slot = lifo_slot });
+    auto hop_times = std::vector<double>();
+
+    for (size_t round = 0; round < n_rounds; round++) {
+        auto chains = std::vector<std::unique_ptr<Chain>>();
+        for (size_t i = 0; i < n_chains; i++) {
+            chains.push_back(std::make_unique<Chain>());
+            chains.back()->hops_left = n_hops;
+        }
+
+        auto start = Clock::now();
+        for (auto& chain : chains) { hop(factory, *chain); }
+        for (auto& chain : chains) {
+            while (!chain->done.load(std::memory_order_acquire)) { std::this_thread::sleep_for(std::chrono::microseconds(100)); }
+        }
+
+        hop_times.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(n_hops));
+    }
+
+    auto steals = uint64_t(0);
+    for (const auto& worker : factory.metrics().workers) { steals += worker.steals; }
+
+    std::ranges::sort(hop_times);
+    std::cout << "lifo slot " << (lifo_slot ? "on " : "off") << ": " << n_chains << " chains of " << n_hops << " hops on "
+              << n_workers << " workers, per hop: median " << hop_times[hop_times.size() / 2] << "ns, min " << hop_times.front()
+              << "ns, steals " << steals << '\n';
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_workers = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 4u;
+    auto n_chains = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 2u;
+    auto n_hops = argc > 3 ? static_cast<size_t>(std::stoul(argv[3])) : 10000u;
+    auto n_rounds = argc > 4 ? static_cast<size_t>(std::stoul(argv[4])) : 20u;
+
+    for (auto lifo_slot : { false, true }) { run(lifo_slot, n_workers, n_chains, n_hops, n_rounds); }
+}
+
+// NOLINTEND
@@ -0,0 +1,51 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Measures the cost of a continuation by building long chains of maps on a pending task and then resolving them. The
+// chains are built twice, once with the default dispatch (every map in the chain is queued as a job once its parent
+// resolves) and once with Cell::Dispatch::Inline (every map runs on the stack of the worker that resolved its parent).
+// Comparing a build with ASYNC_LIB_METRICS on against a build with it off gives the overhead of recording metrics.
+// Passing "prometheus" as the third argument dumps the scheduler's metrics after the run.
+//      map_chain_benchmark [chain_length = 1000] [n_rounds = 200] [prometheus]
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+
+using Clock = std::chrono::steady_clock;
+
+auto main(int argc, char** argv) -> int {
+    auto chain_length = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 1000u;
+    auto n_rounds = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 200u;
+    auto dump_metrics = argc > 3 && std::string(argv[3]) == "prometheus";
+
+    auto task_factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+    for (auto [name, dispatch] : { std::pair("queued", Cell::Dispatch::Queued), std::pair("inline", Cell::Dispatch::Inline) }) {
+        auto round_times = std::vector<double>();
+        for (size_t round = 0; round < n_rounds; round++) {
+            auto source = task_factory.value_source<int>();
+            auto chain = source.create();
+            for (size_t i = 0; i < chain_length; i++) {
+                chain = chain.map<int>([](int x) { return x + 1; }, dispatch);
+            }
+
+            auto start = Clock::now();
+            source.complete(0);
+            static_cast<void>(chain.block());
+            round_times.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(chain_length));
+        }
+
+        std::ranges::sort(round_times);
+        std::cout << "metrics " << (Scheduler::metrics_enabled ? "on" : "off") << ", " << n_rounds << " chains of " << chain_length
+                  << " " << name << " maps, per map: median " << round_times[round_times.size() / 2] << "ns, min " << round_times.front() << "ns\n";
+    }
+
+    if (dump_metrics) { std::cout << task_factory.metrics().to_prometheus(); }
+}
+
+// NOLINTEND
@@ -0,0 +1,52 @@
+// NOLINTBEGIN
+//  Note: this is a helper for the async library's benchmarks and is not a part of the library itself.
+//
+// Process level measurements shared by the benchmarks that compare the memory and CPU held by alternative approaches.
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// cpu_time is the user and system CPU time consumed by the process so far
+inline auto cpu_time() -> std::chrono::microseconds {
+    auto usage = rusage {};
+    getrusage(RUSAGE_SELF, &usage);
+    auto to_micros = [](timeval time) { return std::chrono::seconds(time.tv_sec) + std::chrono::microseconds(time.tv_usec); };
+    return to_micros(usage.ru_utime) + to_micros(usage.ru_stime);
+}
+
+// resident_mb is the memory the process currently has resident
+inline auto resident_mb() -> double {
+    auto statm = std::ifstream("/proc/self/statm");
+    auto size = size_t(0);
+    auto resident = size_t(0);
+    statm >> size >> resident;
+    return static_cast<double>(resident * static_cast<size_t>(sysconf(_SC_PAGESIZE))) / (1024.0 * 1024.0);
+}
+
+// peak_rss_mb is the most memory the process has had resident at any one time
+inline auto peak_rss_mb() -> double {
+    auto usage = rusage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+}
+
+// run_isolated runs a measurement in a forked process so that neither approach inherits the other's heap
+template <typename F>
+auto run_isolated(F measurement) -> void {
+    std::cout << std::flush;
+    if (auto child = fork(); child == 0) {
+        measurement();
+        std::cout << std::flush;
+        _exit(0);
+    } else {
+        waitpid(child, nullptr, 0);
+    }
+}
+
+// NOLINTEND
@@ -0,0 +1,100 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Compares the parallel algorithms of async_lib/parallel.h against the standard library's parallel algorithms
+// (std::execution::par, backed by TBB when it is available) on 1e6 up to 10^max_exponent uint32_t elements:
+//      parallel_algorithms_benchmark [max_exponent = 8] [n_workers = hardware concurrency]
+// 1e9 elements needs ~8GB of memory (an input and an output vector), the best of a few runs is reported for each size.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <execution>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F>
+auto best_of(size_t runs, F func) -> double {
+    auto best = std::chrono::duration<double, std::milli>::max();
+    for (size_t i = 0; i < runs; i++) {
+        auto start = Clock::now();
+        func();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start));
+    }
+
+    return best.count();
+}
+
+auto random_values(size_t size) -> std::vector<uint32_t> {
+    auto values = std::vector<uint32_t>(size);
+    auto state = uint32_t(2463534242);
+    for (auto& value : values) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        value = state;
+    }
+
+    return values;
+}
+
+auto report(const std::string& name, size_t size, double async_ms, double std_ms, bool matches) -> void {
+    std::cout << std::left << std::setw(16) << name << std::right << std::setw(12) << size
+              << std::fixed << std::setprecision(2)
+              << std::setw(12) << async_ms << "ms" << std::setw(12) << std_ms << "ms"
+              << std::setw(8) << std_ms / async_ms << "x" << (matches ? "" : "  MISMATCH") << "\n";
+}
+
+auto main(int argc, char** argv) -> int {
+    auto max_exponent = argc > 1 ? std::stoi(argv[1]) : 8;
+    auto n_workers = argc > 2 ? std::stoi(argv[2]) : static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+
+    auto factory = Async::TaskFactory(n_workers);
+    std::cout << n_workers << " workers, time of parallel.h, time of std::execution::par, speedup of parallel.h\n";
+
+    for (auto exponent = 6; exponent <= max_exponent; exponent++) {
+        auto size = static_cast<size_t>(std::pow(10, exponent));
+        auto runs = size <= 10'000'000 ? size_t(5) : size_t(1);
+        auto input = random_values(size);
+        auto output = std::vector<uint32_t>(size);
+        auto expected = std::vector<uint32_t>(size);
+
+        auto square = [](uint32_t value) { return value * value; };
+        auto async_ms = best_of(runs, [&]() { static_cast<void>(factory.parallel_transform(input.begin(), input.end(), output.begin(), square).block()); });
+        auto std_ms = best_of(runs, [&]() { std::transform(std::execution::par, input.begin(), input.end(), expected.begin(), square); });
+        report("transform", size, async_ms, std_ms, output == expected);
+
+        auto async_sum = uint64_t(0);
+        auto std_sum = uint64_t(0);
+        async_ms = best_of(runs, [&]() { async_sum = std::get<uint64_t>(factory.parallel_reduce(input.begin(), input.end(), uint64_t(0)).block()); });
+        std_ms = best_of(runs, [&]() { std_sum = std::reduce(std::execution::par, input.begin(), input.end(), uint64_t(0)); });
+        report("reduce", size, async_ms, std_ms, async_sum == std_sum);
+
+        async_ms = best_of(runs, [&]() { static_cast<void>(factory.parallel_inclusive_scan(input.begin(), input.end(), output.begin()).block()); });
+        std_ms = best_of(runs, [&]() { std::inclusive_scan(std::execution::par, input.begin(), input.end(), expected.begin()); });
+        report("inclusive_scan", size, async_ms, std_ms, output == expected);
+
+        // every run sorts a fresh copy of the input, the copy is part of the time of both
+        async_ms = best_of(runs, [&]() {
+            output = input;
+            static_cast<void>(factory.parallel_sort(output.begin(), output.end()).block());
+        });
+        std_ms = best_of(runs, [&]() {
+            expected = input;
+            std::sort(std::execution::par, expected.begin(), expected.end());
+        });
+        report("sort", size, async_ms, std_ms, output == expected);
+    }
+}
+
+// NOLINTEND
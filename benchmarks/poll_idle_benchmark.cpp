@@ -0,0 +1,50 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the scheduler and is not a part of the library itself.
+//
+// Measures the cost of the scheduler's poll thread. An idle TaskFactory is left alone for a second and the process'
+// CPU time over that second is reported, it should be close to zero as neither the workers nor the poll thread
+// spin while there is nothing to do. Afterwards timers are scheduled one after another and the lateness of each
+// (the time between its requested expiry and its continuation starting) is reported, the timing wheel has a tick
+// of 50ms so lateness is expected to fall between 0 and a single tick.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+#include "measure.h"
+
+using Clock = std::chrono::steady_clock;
+
+auto main(int argc, char** argv) -> int {
+    auto n_workers = argc > 1 ? std::stoi(argv[1]) : 4;
+    auto n_timers = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 20u;
+
+    auto task_factory = Async::TaskFactory(n_workers);
+    auto timer_source = task_factory.timer_source();
+
+    // let the workers settle into their parked state before measuring
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto cpu_before = cpu_time();
+    auto wall_before = Clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    auto idle_cpu = std::chrono::duration<double>(cpu_time() - cpu_before) / std::chrono::duration<double>(Clock::now() - wall_before);
+
+    auto lateness = std::vector<double>();
+    for (size_t i = 0; i < n_timers; i++) {
+        auto expiry = std::chrono::milliseconds(20 + 37 * (i % 5));
+        auto expected = Clock::now() + expiry;
+        auto fired_at = timer_source.after(expiry).map<Clock::time_point>([](Async::Unit) { return Clock::now(); }).block();
+        lateness.push_back(std::chrono::duration<double, std::milli>(std::get<Clock::time_point>(fired_at) - expected).count());
+    }
+
+    std::ranges::sort(lateness);
+    std::cout << n_workers << " workers, idle cpu usage " << idle_cpu * 100.0 << "% of one core\n";
+    std::cout << n_timers << " timers, lateness min " << lateness.front() << "ms, median " << lateness[lateness.size() / 2]
+              << "ms, max " << lateness.back() << "ms\n";
+}
+
+// NOLINTEND
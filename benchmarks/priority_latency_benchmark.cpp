@@ -0,0 +1,77 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the scheduler and is not a part of the library itself.
+//
+// Measures the enqueue-to-start latency of short probe tasks while the pool is saturated by a deep backlog of CPU
+// bound chunks (think a when_all over a large parallel computation). Two configurations are compared:
+//  - "all normal", the probes and the backlog share the same priority (and hence the same FIFO queues)
+//  - "latency over background", the probes are Latency jobs and the backlog is made up of Background jobs
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+
+using Clock = std::chrono::steady_clock;
+
+auto spin_for(std::chrono::nanoseconds duration) -> void {
+    auto until = Clock::now() + duration;
+    while (Clock::now() < until) {}
+}
+
+auto percentile(std::vector<int64_t>& samples, double p) -> double {
+    std::ranges::sort(samples);
+    auto sample = samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))];
+    return static_cast<double>(sample) / 1000.0;
+}
+
+auto run(unsigned int n_workers, size_t n_probes, Async::Priority probe_priority, Async::Priority load_priority) -> std::vector<int64_t> {
+    auto task_factory = Async::TaskFactory(static_cast<int>(n_workers));
+
+    // the backlog holds roughly 0.5s of work per worker, far longer than the probing phase
+    auto n_chunks = size_t(n_workers) * 20000;
+    auto load = std::vector<Async::Task<int>>();
+    load.reserve(n_chunks);
+    for (size_t i = 0; i < n_chunks; i++) {
+        load.push_back(task_factory.create<int>(load_priority, [] {
+            spin_for(std::chrono::microseconds(25));
+            return 0;
+        }));
+    }
+
+    auto latencies = std::vector<int64_t>();
+    for (size_t i = 0; i < n_probes; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        auto created_at = Clock::now();
+        auto probe = task_factory.create<int64_t>(probe_priority, [created_at]() -> int64_t {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - created_at).count();
+        });
+
+        latencies.push_back(std::get<int64_t>(probe.block()));
+    }
+
+    // the remaining backlog is dropped when the pool is destroyed
+    return latencies;
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_workers = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 4u;
+    auto n_probes = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 100u;
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << n_workers << " workers, " << n_probes << " probes under a saturating backlog\n";
+    std::cout << "configuration\t\t\tp50\t\tp99\n";
+
+    auto all_normal = run(n_workers, n_probes, Async::Priority::Normal, Async::Priority::Normal);
+    std::cout << "all normal\t\t\t" << percentile(all_normal, 0.5) << "us\t" << percentile(all_normal, 0.99) << "us\n";
+
+    auto prioritised = run(n_workers, n_probes, Async::Priority::Latency, Async::Priority::Background);
+    std::cout << "latency over background\t\t" << percentile(prioritised, 0.5) << "us\t" << percentile(prioritised, 0.99) << "us\n";
+}
+
+// NOLINTEND
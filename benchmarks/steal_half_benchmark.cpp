@@ -0,0 +1,65 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the scheduler and is not a part of the library itself.
+//
+// Measures how quickly a fan-out from a single worker is redistributed across the pool. A root job queues n_jobs
+// jobs onto its own worker's queue, every other worker must steal to participate. The per-worker steal counters
+// show how many steal operations were needed to spread the work, with steal-half this is roughly logarithmic in
+// n_jobs rather than linear.
+//
+// An optional third argument names a topology file (see scheduler/topology.h, benchmarks/dual_socket_topology.txt),
+// the workers are then pinned and steal tier by tier, the per-tier counters show how much of the work stayed on the
+// root worker's core and node. Pinning onto cpus the machine doesn't have fails silently so any topology can be simulated.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "scheduler/scheduler.h"
+
+auto spin_for(std::chrono::nanoseconds duration) -> void {
+    auto until = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_workers = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 4u;
+    auto n_jobs = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 10000u;
+
+    auto topology_file = argc > 3 ? std::optional<std::string>(argv[3]) : std::nullopt;
+
+    auto config = Scheduler::SchedulerConfig { .n_workers = n_workers, .pin_workers = topology_file.has_value(), .topology_file = topology_file };
+    auto scheduler = Scheduler::Scheduler(config, {});
+    auto completed = std::atomic<size_t>(0);
+
+    auto start = std::chrono::steady_clock::now();
+    scheduler.queue(Scheduler::Context::empty(), [&](Scheduler::Context ctx) {
+        auto jobs = std::vector<Scheduler::Job>();
+        for (size_t i = 0; i < n_jobs; i++) {
+            jobs.emplace_back([&](Scheduler::Context) {
+                spin_for(std::chrono::microseconds(5));
+                completed.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+
+        scheduler.queue(ctx, std::move(jobs));
+    });
+
+    while (completed.load(std::memory_order_relaxed) < n_jobs) { std::this_thread::yield(); }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+    std::cout << n_workers << " workers, " << n_jobs << " jobs fanned out from one worker in " << elapsed.count() << "ms\n";
+    std::cout << "worker\tsteals\tstolen jobs\tsmt\tnode\tremote\n";
+    auto stats = scheduler.worker_stats();
+    for (size_t worker = 0; worker < stats.size(); worker++) {
+        std::cout << worker << '\t' << stats[worker].steals << '\t' << stats[worker].stolen_jobs;
+        for (auto tier_steals : stats[worker].steals_by_tier) { std::cout << '\t' << tier_steals; }
+        std::cout << '\n';
+    }
+}
+
+// NOLINTEND
@@ -0,0 +1,82 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Counts the number of calls to the global operator new made per task for a handful of common task shapes. Memory
+// obtained from the runtime's slab arenas only reaches the global allocator when an arena grows, hence in steady
+// state this measures the allocations the runtime could not serve from its arenas.
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+#include <functional>
+
+#include "async_lib/task_factory.h"
+
+namespace {
+    std::atomic<uint64_t> global_allocations = 0;
+}
+
+auto operator new(size_t size) -> void* {
+    global_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* allocation = std::malloc(size == 0 ? 1 : size)) { return allocation; }
+    throw std::bad_alloc();
+}
+
+auto operator delete(void* allocation) noexcept -> void { std::free(allocation); }
+auto operator delete(void* allocation, size_t) noexcept -> void { std::free(allocation); }
+
+// measure runs the workload n_iterations times (after a warm up so the arenas have grown) and reports the
+// average number of global allocations per iteration
+auto measure(const char* name, size_t n_iterations, const std::function<void()>& workload) -> void {
+    for (size_t i = 0; i < n_iterations / 10; i++) { workload(); }
+
+    auto allocations_before = global_allocations.load();
+    for (size_t i = 0; i < n_iterations; i++) { workload(); }
+    auto allocations = global_allocations.load() - allocations_before;
+
+    std::cout << name << '\t' << static_cast<double>(allocations) / static_cast<double>(n_iterations) << '\n';
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_iterations = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 10000u;
+    auto task_factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+
+    auto resolved_source = task_factory.value_source<int>();
+    auto resolved = resolved_source.create();
+    resolved_source.complete(1);
+
+    std::cout << "workload\tglobal allocations per iteration\n";
+    measure("create", n_iterations, [&] {
+        static_cast<void>(task_factory.create<int>([] { return 1; }).block());
+    });
+
+    measure("map (resolved)", n_iterations, [&] {
+        static_cast<void>(resolved.map<int>([](int x) { return x + 1; }).block());
+    });
+
+    measure("map chain x4 (pending)", n_iterations, [&] {
+        auto source = task_factory.value_source<int>();
+        auto chain = source.create()
+            .map<int>([](int x) { return x + 1; })
+            .map<int>([](int x) { return x * 2; })
+            .map<int>([](int x) { return x - 1; })
+            .map<int>([](int x) { return x / 2; });
+
+        source.complete(1);
+        static_cast<void>(chain.block());
+    });
+
+    measure("bind (resolved)", n_iterations, [&] {
+        static_cast<void>(resolved.bind<int>([&](int x) { return task_factory.create<int>([x] { return x; }); }).block());
+    });
+
+    measure("when_all x8", n_iterations / 8, [&] {
+        auto tasks = std::vector<Async::Task<int>>();
+        for (int i = 0; i < 8; i++) { tasks.push_back(resolved.map<int>([i](int x) { return x + i; })); }
+        static_cast<void>(task_factory.when_all<int>(tasks).block());
+    });
+}
+
+// NOLINTEND
@@ -0,0 +1,78 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Compares the two ways of bounding a task by a timeout, for short-lived tasks that always beat their timeout:
+//  - when_any, the task raced against timer_source.after(timeout).map(...) to an error value. The losing timer (and its
+//    value source, cells and continuation) stays in the timing wheel until it expires
+//  - with_timeout, Task::with_timeout schedules a single timer which is removed from the wheel once the task wins
+// Each approach runs in a process of its own, the requests are issued in batches which are then waited on. Reports the
+// throughput, the resident memory still held once every request has resolved and the CPU time spent over the window in
+// which the timeouts would have expired.
+//      timeout_benchmark [n_requests = 1000000] [timeout_ms = 2000]
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+#include "measure.h"
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t batch_size = 1000;
+
+template <typename Bound>
+auto measure(const std::string& name, size_t n_requests, std::chrono::milliseconds timeout, Bound bound) -> void {
+    auto factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+    auto timers = factory.timer_source();
+
+    static_cast<void>(timers.after(std::chrono::milliseconds(1)).block());
+    auto rss_before = resident_mb();
+    auto start = Clock::now();
+
+    auto timed_out = size_t(0);
+    for (size_t issued = 0; issued < n_requests; issued += batch_size) {
+        auto requests = std::vector<Async::Task<int>>();
+        for (size_t i = 0; i < batch_size; i++) {
+            requests.push_back(bound(factory, timers, factory.create<int>([i]() { return static_cast<int>(i); }), timeout));
+        }
+
+        for (auto& request : requests) { timed_out += std::holds_alternative<Async::Error>(request.block()) ? 1 : 0; }
+    }
+
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    auto rss_held = resident_mb() - rss_before;
+
+    auto expiry_cpu_before = cpu_time();
+    std::this_thread::sleep_for(timeout + std::chrono::milliseconds(500));
+    auto expiry_cpu = cpu_time() - expiry_cpu_before;
+
+    std::cout << std::left << std::setw(14) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << static_cast<double>(n_requests) / seconds << " req/s"
+              << std::setw(10) << rss_held << "MB held"
+              << std::setw(10) << std::chrono::duration<double, std::milli>(expiry_cpu).count() << "ms cpu at expiry"
+              << std::setw(8) << timed_out << " timed out\n";
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_requests = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 1000000u;
+    auto timeout = std::chrono::milliseconds(argc > 2 ? std::stoi(argv[2]) : 2000);
+
+    std::cout << n_requests << " requests bounded by a " << timeout.count() << "ms timeout\n";
+    run_isolated([&]() {
+        measure("when_any", n_requests, timeout, [](Async::TaskFactory& factory, Async::TaskTimerSource& timers, Async::Task<int> task, std::chrono::milliseconds timeout) {
+            return factory.when_any<int>({ task, timers.after(timeout).map<int>([](Async::Unit) { return -1; }) });
+        });
+    });
+
+    run_isolated([&]() {
+        measure("with_timeout", n_requests, timeout, [](Async::TaskFactory&, Async::TaskTimerSource& timers, Async::Task<int> task, std::chrono::milliseconds timeout) {
+            return task.with_timeout(timers, timeout);
+        });
+    });
+}
+
+// NOLINTEND
@@ -0,0 +1,98 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Measures the copies made while gathering large values with when_all. Each gather resolves n_tasks tasks that each
+// produce a payload of payload_kb KB, gathers them and hands the result to a single map continuation, the payload
+// counts its copies. Three forms are measured:
+//  - when_all, the homogeneous vector form
+//  - when_all_shared, the vector form whose result is shared by its continuations rather than copied into them
+//  - when_all (tuple), the heterogeneous form over a payload, a string and an int (the payload copies are reported)
+// Reports the payload copies per gathered value and the throughput in gathers per second.
+//      when_all_benchmark [n_gathers = 2000] [n_tasks = 8] [payload_kb = 64]
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+
+using Clock = std::chrono::steady_clock;
+
+std::atomic<size_t> payload_copies = 0;
+
+struct Payload {
+    std::vector<char> bytes;
+
+    Payload() = default;
+    explicit Payload(size_t size) : bytes(size, 'x') {}
+    Payload(const Payload& other) : bytes(other.bytes) { payload_copies.fetch_add(1, std::memory_order_relaxed); }
+    Payload(Payload&& other) noexcept = default;
+    auto operator=(const Payload& other) -> Payload& {
+        bytes = other.bytes;
+        payload_copies.fetch_add(1, std::memory_order_relaxed);
+        return *this;
+    }
+    auto operator=(Payload&& other) noexcept -> Payload& = default;
+};
+
+template <typename Gather>
+auto measure(const std::string& name, size_t n_gathers, size_t values_per_gather, Gather gather) -> void {
+    payload_copies.store(0);
+    auto start = Clock::now();
+    auto total_bytes = size_t(0);
+    for (size_t i = 0; i < n_gathers; i++) {
+        total_bytes += std::get<size_t>(gather().block());
+    }
+
+    auto seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(2)
+              << std::setw(8) << static_cast<double>(payload_copies.load()) / static_cast<double>(n_gathers * values_per_gather) << " copies per value"
+              << std::setw(12) << static_cast<double>(n_gathers) / seconds << " gathers/s"
+              << "  (" << total_bytes / n_gathers << " bytes per gather)\n";
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_gathers = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 2000u;
+    auto n_tasks = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 8u;
+    auto payload_size = (argc > 3 ? static_cast<size_t>(std::stoul(argv[3])) : 64u) * 1024;
+
+    auto factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+    auto payloads = [&]() {
+        auto tasks = std::vector<Async::Task<Payload>>();
+        for (size_t i = 0; i < n_tasks; i++) { tasks.push_back(factory.create<Payload>([payload_size]() { return Payload(payload_size); })); }
+        return tasks;
+    };
+
+    std::cout << n_gathers << " gathers of " << n_tasks << " tasks, " << payload_size / 1024 << "KB payloads\n";
+    measure("when_all", n_gathers, n_tasks, [&]() {
+        return factory.when_all<Payload>(payloads()).map<size_t>([](std::vector<Payload> values) {
+            auto size = size_t(0);
+            for (auto& value : values) { size += value.bytes.size(); }
+            return size;
+        });
+    });
+
+    measure("when_all_shared", n_gathers, n_tasks, [&]() {
+        return factory.when_all_shared<Payload>(payloads()).map<size_t>([](std::shared_ptr<const std::vector<Payload>> values) {
+            auto size = size_t(0);
+            for (auto& value : *values) { size += value.bytes.size(); }
+            return size;
+        });
+    });
+
+    measure("when_all (tuple)", n_gathers, 1, [&]() {
+        auto payload = factory.create<Payload>([payload_size]() { return Payload(payload_size); });
+        auto name = factory.create<std::string>([]() { return std::string("payload"); });
+        auto count = factory.create<int>([]() { return 1; });
+        return factory.when_all(payload, name, count).map<size_t>([](std::tuple<Payload, std::string, int> values) {
+            return std::get<0>(values).bytes.size() * static_cast<size_t>(std::get<2>(values));
+        });
+    });
+}
+
+// NOLINTEND
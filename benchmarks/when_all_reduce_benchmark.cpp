@@ -0,0 +1,89 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the async library and is not a part of the library itself.
+//
+// Compares two ways of reducing the results of a large fan-in of tasks, each task produces a partial histogram (8
+// counters) and the histograms are summed:
+//  - when_all + map, the histograms are gathered into a vector (which holds on to every task's cell) and summed by a
+//    final map continuation
+//  - when_all_reduce, each histogram is folded into a per-worker accumulator as it arrives
+// Each approach runs in a process of its own. Reports the peak resident memory of the process, how far the peak rose above
+// the resident memory once every task had been created (ie. the memory held by the reduction rather than by the tasks
+// themselves) and the latency from the first task being created to the reduced histogram, along with the tail from the
+// last task being created.
+//      when_all_reduce_benchmark [n_inputs = 1000000]
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+#include "measure.h"
+
+using Clock = std::chrono::steady_clock;
+using Histogram = std::array<uint64_t, 8>;
+
+auto add(Histogram left, const Histogram& right) -> Histogram {
+    for (size_t i = 0; i < left.size(); i++) { left[i] += right[i]; }
+    return left;
+}
+
+template <typename Reduce>
+auto measure(const std::string& name, size_t n_inputs, Reduce reduce) -> void {
+    auto factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+    static_cast<void>(factory.create<int>([]() { return 0; }).block());
+
+    auto start = Clock::now();
+    auto inputs = std::vector<Async::Task<Histogram>>();
+    inputs.reserve(n_inputs);
+    for (size_t i = 0; i < n_inputs; i++) {
+        inputs.push_back(factory.create<Histogram>([i]() {
+            auto histogram = Histogram {};
+            histogram[i % histogram.size()] = 1;
+            return histogram;
+        }));
+    }
+
+    auto issued = Clock::now();
+    auto rss_issued = resident_mb();
+    auto total = reduce(factory, std::move(inputs));
+    inputs = {};
+    auto result = std::get<Histogram>(total.block());
+    auto end = Clock::now();
+
+    auto count = uint64_t(0);
+    for (auto bucket : result) { count += bucket; }
+
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << peak_rss_mb() << "MB peak rss"
+              << std::setw(10) << peak_rss_mb() - rss_issued << "MB above inputs"
+              << std::setw(10) << std::chrono::duration<double, std::milli>(end - start).count() << "ms latency"
+              << std::setw(10) << std::chrono::duration<double, std::milli>(end - issued).count() << "ms tail"
+              << std::setw(10) << count << " counted\n";
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_inputs = argc > 1 ? static_cast<size_t>(std::stoul(argv[1])) : 1000000u;
+
+    std::cout << n_inputs << " partial histograms reduced\n";
+    run_isolated([&]() {
+        measure("when_all + map", n_inputs, [](Async::TaskFactory& factory, std::vector<Async::Task<Histogram>> inputs) {
+            return factory.when_all<Histogram>(std::move(inputs)).map<Histogram>([](std::vector<Histogram> histograms) {
+                auto total = Histogram {};
+                for (auto& histogram : histograms) { total = add(total, histogram); }
+                return total;
+            });
+        });
+    });
+
+    run_isolated([&]() {
+        measure("when_all_reduce", n_inputs, [](Async::TaskFactory& factory, std::vector<Async::Task<Histogram>> inputs) {
+            return factory.when_all_reduce(std::move(inputs), Histogram {}, [](Histogram total, const Histogram& histogram) { return add(total, histogram); });
+        });
+    });
+}
+
+// NOLINTEND
@@ -0,0 +1,103 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the concurrency library and is not a part of the library itself.
+//
+// Compares the throughput of the lock-free WorkStealingDeque against a single SpinLock guarded FIFO
+// (the design the per-worker JobQueue used previously) under a fan-out workload. Each item of depth d
+// spawns two items of depth d - 1 onto the queue of the thread that executed it, the root is placed on
+// thread 0's queue hence every other thread must steal to find work.
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include <memory>
+
+#include "concurrency/spinlock.h"
+#include "concurrency/work_stealing_deque.h"
+
+struct Item {
+    unsigned int depth;
+};
+
+template <typename T>
+class SpinLockedQueue {
+public:
+    auto push(T&& item) -> void {
+        const std::lock_guard<SpinLock> lock(spinlock);
+        queue.push_back(std::move(item));
+    }
+
+    auto pop() -> std::optional<T> { return take(); }
+    auto steal() -> std::optional<T> { return take(); }
+
+private:
+    auto take() -> std::optional<T> {
+        const std::lock_guard<SpinLock> lock(spinlock);
+        if (queue.empty()) { return std::nullopt; }
+        auto item = std::optional<T>(std::move(queue.front()));
+        queue.pop_front();
+        return item;
+    }
+
+    SpinLock spinlock;
+    std::deque<T> queue;
+};
+
+template <typename Queue>
+auto run_fan_out(unsigned int n_threads, unsigned int depth) -> double {
+    auto queues = std::vector<std::unique_ptr<Queue>>();
+    for (auto i = 0u; i < n_threads; i++) { queues.push_back(std::make_unique<Queue>()); }
+
+    auto total_items = (uint64_t(1) << (depth + 1)) - 1;
+    auto completed = std::atomic<uint64_t>(0);
+    queues[0]->push(Item { depth });
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        auto threads = std::vector<std::jthread>();
+        for (auto id = 0u; id < n_threads; id++) {
+            threads.emplace_back([&, id]() {
+                auto rng = uint64_t(id) * 0x9E3779B97F4A7C15ull + 1;
+                auto& own = *queues[id];
+                while (completed.load(std::memory_order_relaxed) < total_items) {
+                    auto item = own.pop();
+                    if (!item.has_value()) {
+                        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+                        item = queues[rng % n_threads]->steal();
+                    }
+
+                    if (!item.has_value()) { continue; }
+                    if (item->depth > 0) {
+                        own.push(Item { item->depth - 1 });
+                        own.push(Item { item->depth - 1 });
+                    }
+                    completed.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+    }
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(total_items) / elapsed;
+}
+
+auto main(int argc, char** argv) -> int {
+    auto depth = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 18u;
+    auto max_threads = argc > 2 ? static_cast<unsigned int>(std::stoul(argv[2])) : 64u;
+
+    std::cout << "fan-out depth " << depth << " (" << ((uint64_t(1) << (depth + 1)) - 1) << " items)\n";
+    std::cout << "threads\tspinlock queue (items/s)\twork stealing deque (items/s)\tspeedup\n";
+    for (auto n_threads = 1u; n_threads <= max_threads; n_threads *= 2) {
+        auto locked = run_fan_out<SpinLockedQueue<Item>>(n_threads, depth);
+        auto lock_free = run_fan_out<WorkStealingDeque<Item>>(n_threads, depth);
+        std::cout << n_threads << '\t' << static_cast<uint64_t>(locked) << '\t' << static_cast<uint64_t>(lock_free)
+                  << '\t' << lock_free / locked << "x\n";
+    }
+}
+
+// NOLINTEND
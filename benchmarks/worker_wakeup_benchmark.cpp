@@ -0,0 +1,63 @@
+// NOLINTBEGIN
+//  Note: this is a benchmark for the scheduler and is not a part of the library itself.
+//
+// Measures the latency between creating a task and a worker starting to execute it. Samples are taken in two regimes:
+//  - "idle", a pause between samples gives every worker time to exhaust its spin/yield budget and park on the pool's
+//    eventcount, the latency therefore includes a futex wake
+//  - "busy", samples are issued back to back so the workers are still spinning when the next task arrives
+// Idle workers no longer burn CPU, this benchmark tracks what that costs in wake-up latency.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+
+using Clock = std::chrono::steady_clock;
+
+auto sample_latency(Async::TaskFactory& task_factory, std::chrono::microseconds pause) -> int64_t {
+    std::this_thread::sleep_for(pause);
+
+    auto created_at = Clock::now();
+    auto task = task_factory.create<int64_t>([created_at]() -> int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - created_at).count();
+    });
+
+    return std::get<int64_t>(task.block());
+}
+
+auto report(const char* name, std::vector<int64_t> samples) -> void {
+    std::ranges::sort(samples);
+    auto percentile = [&samples](double p) {
+        auto sample = samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))];
+        return static_cast<double>(sample) / 1000.0;
+    };
+
+    std::cout << name << "\tp50 " << percentile(0.50) << "us\tp99 " << percentile(0.99)
+              << "us\tmax " << percentile(1.0) << "us\n";
+}
+
+auto main(int argc, char** argv) -> int {
+    auto n_workers = argc > 1 ? static_cast<unsigned int>(std::stoul(argv[1])) : 4u;
+    auto n_samples = argc > 2 ? static_cast<size_t>(std::stoul(argv[2])) : 200u;
+
+    auto task_factory = Async::TaskFactory(n_workers);
+    auto idle = std::vector<int64_t>();
+    auto busy = std::vector<int64_t>();
+    for (size_t i = 0; i < n_samples; i++) {
+        idle.push_back(sample_latency(task_factory, std::chrono::milliseconds(20)));
+    }
+
+    for (size_t i = 0; i < n_samples; i++) {
+        busy.push_back(sample_latency(task_factory, std::chrono::microseconds(0)));
+    }
+
+    std::cout << n_workers << " workers, " << n_samples << " samples, enqueue to start latency\n";
+    report("idle (parked)", std::move(idle));
+    report("busy (spinning)", std::move(busy));
+}
+
+// NOLINTEND
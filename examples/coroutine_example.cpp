@@ -0,0 +1,55 @@
+// NOLINTBEGIN
+//  Note: this is just a test file to demonstrate how to use the library
+//        and is not a part of the library itself.
+//
+// Writes multi step async logic as coroutines returning tasks rather than as nested binds. fib awaits tasks that are
+// themselves coroutines, checkout awaits a timer and an externally resolved task and short circuits on its error.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <variant>
+
+#include "async_lib/coroutine.h"
+#include "async_lib/task_factory.h"
+
+auto fib(Async::TaskFactory& factory, int n) -> Async::Task<int> {
+    if (n < 2) { co_return n; }
+
+    auto lhs = fib(factory, n - 1);
+    auto rhs = fib(factory, n - 2);
+    co_return co_await lhs + co_await rhs;
+}
+
+auto checkout(Async::TaskFactory& factory, Async::TaskTimerSource& timer_source, Async::Task<int> payment) -> Async::Task<int> {
+    auto basket = co_await factory.create<int>([]() { return 40; });
+    co_await timer_source.after(std::chrono::milliseconds(10));
+
+    // an errored payment abandons the coroutine here, the task returned by checkout resolves to the same error
+    auto paid = co_await payment;
+    co_return paid - basket;
+}
+
+auto main() -> int {
+    auto factory = Async::TaskFactory(/* N_WORKERS = */ 2);
+    auto timer_source = factory.timer_source();
+
+    auto result = std::get<int>(fib(factory, 15).block());
+    std::cout << "fib(15) = " << result << std::endl;
+
+    auto accepted = factory.value_source<int>();
+    auto rejected = factory.value_source<int>();
+    auto change = checkout(factory, timer_source, accepted.create());
+    auto failed = checkout(factory, timer_source, rejected.create());
+    accepted.complete(50);
+    rejected.error(Async::Error::Rejected);
+
+    auto change_value = std::get<int>(change.block());
+    auto failed_error = std::get<Async::Error>(failed.block());
+    std::cout << "Change: " << change_value << std::endl;
+    std::cout << "Failed checkout: " << Async::error_to_string(failed_error) << std::endl;
+
+    return result == 610 && change_value == 10 && failed_error == Async::Error::Rejected ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// NOLINTEND
@@ -0,0 +1,58 @@
+// NOLINTBEGIN
+//  Note: this is just a test file to demonstrate how to use the library
+//        and is not a part of the library itself.
+//
+// Blocks on tasks from within tasks on a scheduler with a single worker. Each fib task creates two child tasks and
+// blocks on both, as the only worker is the one blocking the children can only run because a blocked worker keeps
+// running queued jobs until the task it is waiting on resolves. Without that this example deadlocks. The same goes for
+// the task returned by bind, which only resolves once the bound task has been created and then resolved.
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <variant>
+
+#include "async_lib/task_factory.h"
+
+auto fib(Async::TaskFactory& factory, int n) -> Async::Task<int> {
+    return factory.create<int>([&factory, n]() {
+        if (n < 2) { return n; }
+
+        auto lhs = fib(factory, n - 1);
+        auto rhs = fib(factory, n - 2);
+        return std::get<int>(lhs.block()) + std::get<int>(rhs.block());
+    });
+}
+
+auto main(int argc, char** argv) -> int {
+    auto factory = Async::TaskFactory(/* N_WORKERS = */ 1);
+
+    auto n = argc > 1 ? std::atoi(argv[1]) : 20;
+    auto result = std::get<int>(fib(factory, n).block());
+    std::cout << "fib(" << n << ") = " << result << std::endl;
+
+    auto expected = 0;
+    for (auto i = 0, next = 1; i < n; i++) { expected = std::exchange(next, expected + next); }
+
+    // a task that blocks on a timer can only resolve once the worker polls the timer itself (or the poll thread does)
+    auto timer_source = factory.timer_source();
+    auto waited = factory.create<int>([&timer_source]() {
+        static_cast<void>(timer_source.after(std::chrono::milliseconds(10)).block());
+        return 1;
+    }).block();
+    std::cout << "Blocked on a timer from a worker: " << std::get<int>(waited) << std::endl;
+
+    auto bound = factory.create<int>([&factory]() {
+        auto doubled = factory.create<int>([]() { return 21; }).bind<int>([&factory](int x) {
+            return factory.create<int>([x]() { return 2 * x; });
+        });
+        return std::get<int>(doubled.block());
+    }).block();
+    std::cout << "Blocked on a bind from a worker: " << std::get<int>(bound) << std::endl;
+
+    return result == expected && std::get<int>(bound) == 42 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// NOLINTEND
@@ -0,0 +1,47 @@
+// NOLINTBEGIN
+//  Note: this is just a test file to demonstrate how to use the library
+//        and is not a part of the library itself.
+//
+// Records a trace of a small pipeline of maps, binds and a when_all and writes it to trace.json (or the path given as
+// the first argument), open the file in ui.perfetto.dev to see which worker ran each job and when.
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "async_lib/task_factory.h"
+#include "scheduler/tracer.h"
+
+using std::chrono_literals::operator""ms;
+
+auto main(int argc, char** argv) -> int {
+    auto trace_path = argc > 1 ? std::string(argv[1]) : std::string("trace.json");
+    auto task_factory = Async::TaskFactory(/* N_WORKERS = */ 3);
+    auto timer_source = task_factory.timer_source();
+
+    Scheduler::Tracer::start();
+
+    auto tasks = std::vector<Async::Task<int>>();
+    for (int i = 0; i < 8; i++) {
+        tasks.push_back(task_factory.create<int>([i] { return i; })
+            .map<int>([](int x) { return x * x; })
+            .bind<int>([&timer_source](int x) {
+                return timer_source.after(10ms).map<int>([x](Async::Unit) { return x + 1; });
+            }));
+    }
+
+    auto result = task_factory.when_all<int>(tasks).block();
+    Scheduler::Tracer::stop();
+
+    auto sum = 0;
+    for (auto value : std::get<std::vector<int>>(result)) { sum += value; }
+    std::cout << "Result: " << sum << '\n';
+
+    auto trace_file = std::ofstream(trace_path);
+    Scheduler::Tracer::write_chrome_trace(trace_file);
+    std::cout << "Trace written to " << trace_path << '\n';
+}
+
+// NOLINTEND
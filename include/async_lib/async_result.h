@@ -6,6 +6,8 @@ namespace Async {
     enum Error {
         Rejected,
         IOError,
+        Cancelled,  // the task's CancellationToken was cancelled before the task resolved
+        Timeout,    // the task did not resolve before its deadline, see Task::with_timeout
     };
 
     auto inline error_to_string(Error error) -> const char* {
@@ -14,6 +16,10 @@ namespace Async {
                 return "Rejected";
             case IOError:
                 return "IOError";
+            case Cancelled:
+                return "Cancelled";
+            case Timeout:
+                return "Timeout";
             default:
                 return "Unknown";
         }
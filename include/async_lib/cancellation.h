@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "concurrency/spinlock.h"
+#include "scheduler/inplace_function.h"
+
+// Cancellation of tasks, a CancellationSource mints CancellationTokens that are attached to tasks (see
+// Task::with_cancellation, TaskFactory::create, TaskTimerSource::after and TaskIOSource::read). Cancelling the source
+// resolves every pending task the token is attached to with Async::Error::Cancelled, a cancelled task's continuations
+// observe the error as they would any other and so cancellation propagates down map/bind chains.
+//  - continuations of a task with a token inherit the token, a continuation that is cancelled before it runs is skipped
+//  - timers and IO reads created with a token are removed from the timing wheel / aio_cancelled upon cancellation,
+//    releasing the memory they hold rather than waiting for them to expire
+// Tokens are cheap to copy (a shared_ptr), a default constructed token can never be cancelled and attaching one is free.
+namespace Async {
+    // CancellationCallback is invoked once upon cancellation, it is allocation free for captures of up to 64 bytes
+    using CancellationCallback = Scheduler::InplaceFunction<void(), 64>;
+
+    namespace Cancellation {
+        struct State;
+
+        // Node holds a registered callback, a node is shared by its registration and (while it is registered) the
+        // list of its state, hence neither cancel() nor the registration can free a node from under the other
+        struct Node {
+            CancellationCallback callback;
+            std::shared_ptr<State> state;
+            std::shared_ptr<Node> self;
+            Node* prev;
+            Node* next;
+        };
+
+        // State is shared by a source and its tokens, registered callbacks form an intrusive list guarded by the spinlock.
+        // cancel() unlinks the whole list under the lock and then invokes the callbacks outside of it, hence a
+        // registration that observes the state as cancelled must leave its node's links alone
+        struct State {
+            SpinLock spinlock;
+            std::atomic<bool> cancelled = { false };
+            Node* head = nullptr;
+        };
+    }
+
+    // CancellationRegistration unregisters its callback when it is destroyed (or reset), a registration is a single
+    // shared_ptr sized so that continuations can carry one without outgrowing their inline buffer
+    class CancellationRegistration {
+    public:
+        CancellationRegistration() = default;
+        ~CancellationRegistration() { reset(); }
+
+        CancellationRegistration(CancellationRegistration&& other) noexcept = default;
+        auto operator=(CancellationRegistration&& other) noexcept -> CancellationRegistration&;
+        CancellationRegistration(const CancellationRegistration&) = delete;
+        auto operator=(const CancellationRegistration&) -> CancellationRegistration& = delete;
+
+        // is_cancelled is true once the token the callback was registered with has been cancelled
+        [[nodiscard]] auto is_cancelled() const -> bool;
+        auto reset() -> void;
+
+    private:
+        friend class CancellationToken;
+
+        explicit CancellationRegistration(std::shared_ptr<Cancellation::Node> node) : node(std::move(node)) {}
+
+        std::shared_ptr<Cancellation::Node> node;
+    };
+
+    class CancellationToken {
+    public:
+        // a default constructed token is never cancelled
+        CancellationToken() = default;
+
+        [[nodiscard]] auto is_cancelled() const -> bool { return state != nullptr && state->cancelled.load(std::memory_order_acquire); }
+        [[nodiscard]] auto can_be_cancelled() const -> bool { return state != nullptr; }
+
+        // on_cancel registers a callback to be invoked by the thread that cancels the token, if the token is already
+        // cancelled the callback is invoked straight away. The callback is unregistered once the registration is destroyed,
+        // note that a callback racing the destruction of its registration may still be invoked hence it must own whatever
+        // it touches
+        [[nodiscard]] auto on_cancel(CancellationCallback callback) const -> CancellationRegistration;
+
+    private:
+        friend class CancellationSource;
+        explicit CancellationToken(std::shared_ptr<Cancellation::State> state) : state(std::move(state)) {}
+
+        std::shared_ptr<Cancellation::State> state;
+    };
+
+    class CancellationSource {
+    public:
+        CancellationSource();
+
+        [[nodiscard]] auto token() const -> CancellationToken { return CancellationToken(state); }
+        [[nodiscard]] auto is_cancelled() const -> bool { return state->cancelled.load(std::memory_order_acquire); }
+
+        // cancel invokes every registered callback on the calling thread, only the first call cancels the source and
+        // returns true
+        auto cancel() const -> bool;
+
+    private:
+        std::shared_ptr<Cancellation::State> state;
+    };
+}
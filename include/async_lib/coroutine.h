@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "concurrency/slab_allocator.h"
+#include "scheduler/job.h"
+#include "scheduler/scheduler_intf.h"
+#include "scheduler/scheduling_context.h"
+#include "cell/cell.h"
+#include "async_lib/async_result.h"
+#include "async_lib/task.h"
+#include "async_lib/task_factory.h"
+#include "async_lib/task_value_source.h"
+
+// Coroutine support for tasks, a function returning a Task<T> may be written as a coroutine that co_awaits other tasks:
+//
+//      auto add_then_double(Async::TaskFactory& factory, int x) -> Async::Task<int> {
+//          auto sum = co_await factory.create<int>([x]() { return x + 1; });
+//          auto doubled = co_await factory.create<int>([sum]() { return sum * 2; });
+//          co_return sum + doubled;
+//      }
+//
+//  - the coroutine must take a TaskFactory or an IScheduler parameter by reference (the first one is used), its body runs
+//    as jobs on that scheduler. Invoking the coroutine queues its first job and returns its task straight away
+//  - co_await resolves to the value of the awaited task, if the awaited task resolves to an error the coroutine is
+//    abandoned (its frame is destroyed) and its own task resolves to the same error, just as with bind
+//  - awaiting a task that has already resolved does not suspend the coroutine at all, it carries straight on. Otherwise the
+//    coroutine is resumed on the worker it was suspended on, inline if that worker is the one resolving the awaited task
+//    (see IScheduler::run_inline) and injected into that worker's inject queue if not (see JobWorker::inject)
+//  - coroutine frames are allocated from the calling thread's slab arena, see SlabArena
+// An exception escaping a coroutine terminates the program, as it would escaping the function of a task.
+namespace Async {
+    template <typename T>
+    class TaskPromise {
+    public:
+        // the promise is constructed from the coroutine's parameters, the scheduler is taken from the first of them that
+        // is a TaskFactory or an IScheduler
+        template <typename... Args>
+        explicit TaskPromise(Args&... args);
+
+        [[nodiscard]] static auto operator new(size_t size) -> void* { return SlabArena::allocate(size); }
+        static auto operator delete(void* frame) noexcept -> void { SlabArena::deallocate(frame); }
+
+        // Schedule suspends the coroutine upon creation and queues its first job
+        struct Schedule {
+            [[nodiscard]] auto await_ready() const noexcept -> bool { return false; }
+            auto await_suspend(std::coroutine_handle<TaskPromise> handle) const -> void;
+            auto await_resume() const noexcept -> void {}
+        };
+
+        [[nodiscard]] auto get_return_object() -> Task<T> { return source.create(); }
+        [[nodiscard]] auto initial_suspend() const noexcept -> Schedule { return {}; }
+        [[nodiscard]] auto final_suspend() const noexcept -> std::suspend_never { return {}; }
+
+        auto return_value(T value) -> void { source.complete(current_context, std::move(value)); }
+        auto unhandled_exception() -> void { std::terminate(); }
+
+        // resume runs the coroutine up until its next suspension point from a job running in ctx, fail instead resolves
+        // the coroutine's task to error and destroys the coroutine
+        static auto resume(std::coroutine_handle<TaskPromise> handle, Scheduler::Context ctx) -> void;
+        static auto fail(std::coroutine_handle<TaskPromise> handle, Scheduler::Context ctx, Async::Error error) -> void;
+
+        [[nodiscard]] auto context() const -> Scheduler::Context { return current_context; }
+        [[nodiscard]] auto scheduler() const -> Scheduler::IScheduler& { return promise_scheduler; }
+
+    private:
+        template <typename Arg>
+        constexpr static bool is_scheduler_source = std::is_base_of_v<Scheduler::IScheduler, Arg> || std::is_same_v<TaskFactory, std::remove_cv_t<Arg>>;
+
+        template <typename Arg, typename... Args>
+        [[nodiscard]] static auto scheduler_of(Arg& arg, Args&... args) -> Scheduler::IScheduler&;
+
+        std::reference_wrapper<Scheduler::IScheduler> promise_scheduler;
+        TaskValueSource<T> source;
+        // the context of the job the coroutine is currently running in, the coroutine is resumed on its worker
+        Scheduler::Context current_context = Scheduler::Context::empty();
+    };
+
+    // TaskAwaiter suspends a coroutine on the cell of a task. The cell's continuation races await_suspend, a continuation
+    // that runs before await_suspend completes (ie. the cell was written in the meantime) leaves await_suspend to carry
+    // on with the coroutine rather than resume it a second time
+    template <typename T>
+    class TaskAwaiter {
+    public:
+        explicit TaskAwaiter(const Task<T>& task) : cell(task.cell) {}
+
+        [[nodiscard]] auto await_ready() -> bool;
+        template <typename G>
+        [[nodiscard]] auto await_suspend(std::coroutine_handle<TaskPromise<G>> handle) -> bool;
+        [[nodiscard]] auto await_resume() -> T { return std::get<T>(std::move(result.value())); } // NOLINT(bugprone-unchecked-optional-access)
+
+    private:
+        enum class State : uint8_t {
+            Suspending,
+            Suspended,
+            Resolved,
+        };
+
+        std::shared_ptr<Cell::ICell<T, Async::Error>> cell;
+        std::optional<Cell::Result<T, Async::Error>> result;
+        std::atomic<State> state = { State::Suspending };
+    };
+
+    template <typename T>
+    [[nodiscard]] auto operator co_await(const Task<T>& task) -> TaskAwaiter<T> { return TaskAwaiter<T>(task); }
+}
+
+template <typename T, typename... Args>
+struct std::coroutine_traits<Async::Task<T>, Args...> {
+    using promise_type = Async::TaskPromise<T>;
+};
+
+
+
+
+
+
+// Implementation
+template <typename T>
+template <typename... Args>
+Async::TaskPromise<T>::TaskPromise(Args&... args) : promise_scheduler(scheduler_of(args...)), source(promise_scheduler) {
+    static_assert((is_scheduler_source<Args> || ...), "a coroutine returning a Task must take a TaskFactory& or an IScheduler& parameter");
+}
+
+template <typename T>
+template <typename Arg, typename... Args>
+auto Async::TaskPromise<T>::scheduler_of(Arg& arg, Args&... args) -> Scheduler::IScheduler& {
+    if constexpr (std::is_base_of_v<Scheduler::IScheduler, Arg>) {
+        return arg;
+    } else if constexpr (std::is_same_v<TaskFactory, std::remove_cv_t<Arg>>) {
+        return *arg.scheduler;
+    } else {
+        return scheduler_of(args...);
+    }
+}
+
+template <typename T>
+auto Async::TaskPromise<T>::Schedule::await_suspend(std::coroutine_handle<TaskPromise> handle) const -> void {
+    handle.promise().scheduler().queue(Scheduler::Context::empty(), [handle](auto ctx) { TaskPromise::resume(handle, ctx); });
+}
+
+template <typename T>
+auto Async::TaskPromise<T>::resume(std::coroutine_handle<TaskPromise> handle, Scheduler::Context ctx) -> void {
+    handle.promise().current_context = ctx;
+    handle.resume();
+}
+
+template <typename T>
+auto Async::TaskPromise<T>::fail(std::coroutine_handle<TaskPromise> handle, Scheduler::Context ctx, Async::Error error) -> void {
+    handle.promise().source.error(ctx, error);
+    handle.destroy();
+}
+
+
+// an errored task is never ready as the coroutine must instead be abandoned within await_suspend
+template <typename T>
+auto Async::TaskAwaiter<T>::await_ready() -> bool {
+    auto value = cell->read();
+    if (!value.has_value() || !std::holds_alternative<T>(value.value())) { return false; }
+
+    result = std::move(value);
+    return true;
+}
+
+// the continuation only forwards the result and so is dispatched inline, it then resumes the coroutine on the worker the
+// coroutine was suspended on. The acq_rel exchanges order the continuation's write of result before its read by
+// whichever side goes on to resume the coroutine
+template <typename T>
+template <typename G>
+auto Async::TaskAwaiter<T>::await_suspend(std::coroutine_handle<TaskPromise<G>> handle) -> bool {
+    auto callback = [this, handle](Scheduler::Context, Cell::Result<T, Async::Error> value) {
+        result = std::move(value);
+        if (state.exchange(State::Resolved, std::memory_order_acq_rel) == State::Suspending) { return; }
+
+        auto& scheduler = handle.promise().scheduler();
+        auto suspended_ctx = handle.promise().context();
+        auto job = Scheduler::Job([this, handle](auto ctx) {
+            if (auto* error = std::get_if<Async::Error>(&result.value()); error != nullptr) { // NOLINT(bugprone-unchecked-optional-access)
+                TaskPromise<G>::fail(handle, ctx, *error);
+            } else {
+                TaskPromise<G>::resume(handle, ctx);
+            }
+        });
+
+        if (!scheduler.run_inline(suspended_ctx, job)) { scheduler.queue(suspended_ctx, std::move(job)); }
+    };
+
+    static_assert(Cell::Callback<T, Async::Error>::template stored_inline<decltype(callback)>, "co_await continuations must not allocate");
+    cell->await(std::move(callback), Cell::Dispatch::Inline);
+    if (state.exchange(State::Suspended, std::memory_order_acq_rel) == State::Suspending) { return true; }
+
+    // the cell was written while the continuation was being registered
+    if (auto* error = std::get_if<Async::Error>(&result.value()); error != nullptr) { // NOLINT(bugprone-unchecked-optional-access)
+        TaskPromise<G>::fail(handle, handle.promise().context(), *error);
+        return true;
+    }
+
+    return false;
+}
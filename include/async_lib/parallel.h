@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "concurrency/slab_allocator.h"
+#include "scheduler/scheduler_intf.h"
+#include "async_lib/task.h"
+#include "async_lib/task_value_source.h"
+#include "async_lib/types.h"
+
+// The parallel algorithms split a range across the scheduler's workers and return a task that resolves once the entire
+// range has been processed. The range (and anything func/op reference) must outlive the returned task.
+// Ranges are split by recursive binary splitting, a job halves its range, queues the right half onto its own worker and
+// carries on with the left half until it is left with a leaf. Idle workers balance the load by stealing the queued halves,
+// thieves take the oldest (and hence largest) halves first. The number of splits adapts to the load:
+//  - a range is initially split into roughly four leaves per worker (see SplitJoin::initial_budget)
+//  - a stolen half may always be split a further steal_budget times, so a thief splits off work for other idle workers
+//  - a range is never split into halves smaller than grain elements
+// Leaves hand their results up a tree of join nodes, the second child of a node to finish joins both results and carries
+// on up the tree. Only the root writes a cell, hence an algorithm costs a single cell rather than a cell per chunk.
+namespace Async {
+    // parallel_for invokes func(i) for every i in [begin, end)
+    template <typename F>
+    [[nodiscard]] auto parallel_for(Scheduler::IScheduler& scheduler, size_t begin, size_t end, F func, size_t grain = 1) -> Task<Unit>;
+
+    // parallel_transform writes func(element) to the corresponding element of the range beginning at d_first
+    template <std::random_access_iterator It, std::random_access_iterator OutIt, typename F>
+    [[nodiscard]] auto parallel_transform(Scheduler::IScheduler& scheduler, It first, It last, OutIt d_first, F func, size_t grain = 1) -> Task<Unit>;
+
+    // parallel_reduce folds the range into init using op, op must be associative but need not be commutative
+    template <std::random_access_iterator It, typename T, typename Op = std::plus<>>
+    [[nodiscard]] auto parallel_reduce(Scheduler::IScheduler& scheduler, It first, It last, T init, Op op = {}, size_t grain = 1) -> Task<T>;
+
+    // parallel_inclusive_scan writes the inclusive prefix sums (under op) of the range to the range beginning at d_first,
+    // op must be associative. The scan makes two passes, the first totals each chunk of the input and the second scans
+    // each chunk into the output starting from the total of the chunks preceding it
+    template <std::random_access_iterator It, std::random_access_iterator OutIt, typename Op = std::plus<>>
+    [[nodiscard]] auto parallel_inclusive_scan(Scheduler::IScheduler& scheduler, It first, It last, OutIt d_first, Op op = {}, size_t grain = 1) -> Task<Unit>;
+
+    // parallel_sort sorts the range using comp, leaves are sorted with std::sort and merged in place as they are joined
+    template <std::random_access_iterator It, typename Compare = std::less<>>
+    [[nodiscard]] auto parallel_sort(Scheduler::IScheduler& scheduler, It first, It last, Compare comp = {}, size_t grain = 1) -> Task<Unit>;
+
+    namespace Parallel {
+        // SplitJoin runs leaf(begin, end) -> R over the chunks of a range and joins the results of adjacent chunks using
+        // join(begin, mid, end, R left, R right) -> R, the joined result of the entire range resolves the task
+        template <typename R, typename Leaf, typename Join>
+        class SplitJoin : public std::enable_shared_from_this<SplitJoin<R, Leaf, Join>> {
+        public:
+            SplitJoin(Scheduler::IScheduler& scheduler, size_t grain, Leaf leaf, Join join);
+
+            [[nodiscard]] static auto run(Scheduler::IScheduler& scheduler, size_t begin, size_t end, size_t grain, Leaf leaf, Join join) -> Task<R>;
+
+        private:
+            enum class Side : uint8_t {
+                Left,
+                Right,
+            };
+
+            // Node joins the two halves of a split range, whichever half finishes first leaves its result in the node
+            struct Node {
+                Node(std::shared_ptr<Node> parent, Side side, size_t begin, size_t mid, size_t end) :
+                    parent(std::move(parent)), side(side), begin(begin), mid(mid), end(end) {}
+
+                std::shared_ptr<Node> parent;
+                Side side;
+                size_t begin;
+                size_t mid;
+                size_t end;
+                std::optional<R> left;
+                std::optional<R> right;
+                std::atomic<bool> has_sibling_result = { false };
+            };
+
+            auto split(Scheduler::Context ctx, size_t begin, size_t end, unsigned int budget, std::shared_ptr<Node> parent, Side side) -> void;
+            auto complete(Scheduler::Context ctx, std::shared_ptr<Node> node, Side side, R value) -> void;
+
+            constexpr static unsigned int steal_budget = 2;
+
+            std::reference_wrapper<Scheduler::IScheduler> scheduler;
+            size_t grain;
+            unsigned int initial_budget;
+            Leaf leaf;
+            Join join;
+            TaskValueSource<R> result;
+        };
+
+        template <std::random_access_iterator It>
+        [[nodiscard]] auto at(It it, size_t offset) -> It { return std::next(it, static_cast<std::iter_difference_t<It>>(offset)); }
+    }
+}
+
+
+
+
+
+
+// Implementation
+template <typename R, typename Leaf, typename Join>
+Async::Parallel::SplitJoin<R, Leaf, Join>::SplitJoin(Scheduler::IScheduler& scheduler, size_t grain, Leaf leaf, Join join) :
+    scheduler(scheduler),
+    grain(std::max(grain, size_t(1))),
+    // ceil(log2(workers)) splits give a leaf per worker, two more splits give each worker four leaves to balance with
+    initial_budget(static_cast<unsigned int>(std::bit_width(std::max(scheduler.concurrency(), 1u) - 1u)) + 2),
+    leaf(std::move(leaf)),
+    join(std::move(join)),
+    result(scheduler) {}
+
+template <typename R, typename Leaf, typename Join>
+auto Async::Parallel::SplitJoin<R, Leaf, Join>::run(Scheduler::IScheduler& scheduler, size_t begin, size_t end, size_t grain, Leaf leaf, Join join) -> Task<R> {
+    auto split_join = std::allocate_shared<SplitJoin>(SlabAllocator<SplitJoin>(), scheduler, grain, std::move(leaf), std::move(join));
+    auto task = split_join->result.create();
+    scheduler.queue(Scheduler::Context::empty(), [split_join, begin, end](auto ctx) {
+        split_join->split(ctx, begin, end, split_join->initial_budget, nullptr, Side::Left);
+    });
+
+    return task;
+}
+
+// split queues the right half of the range and keeps the left half until it runs out of budget or the halves would fall
+// below the grain. The right half is queued onto this worker so it is only run elsewhere if another worker is idle, a
+// half that is run by a different thread than the one that queued it was stolen and may split a further steal_budget times
+template <typename R, typename Leaf, typename Join>
+auto Async::Parallel::SplitJoin<R, Leaf, Join>::split(Scheduler::Context ctx, size_t begin, size_t end, unsigned int budget, std::shared_ptr<Node> parent, Side side) -> void {
+    while (budget > 0 && end - begin >= 2 * grain) {
+        auto mid = begin + (end - begin) / 2;
+        auto node = std::allocate_shared<Node>(SlabAllocator<Node>(), std::move(parent), side, begin, mid, end);
+        budget -= 1;
+
+        scheduler.get().queue(ctx, [self = this->shared_from_this(), node, mid, end, budget, owner = std::this_thread::get_id()](auto ctx) {
+            auto stolen = std::this_thread::get_id() != owner;
+            self->split(ctx, mid, end, stolen ? std::max(budget, steal_budget) : budget, node, Side::Right);
+        });
+
+        parent = std::move(node);
+        side = Side::Left;
+        end = mid;
+    }
+
+    complete(ctx, std::move(parent), side, leaf(begin, end));
+}
+
+// complete hands the result of a range to its node, the exchange orders the first child's write of its result before
+// the second child's read of it. The second child joins the results and continues with the node's own parent
+template <typename R, typename Leaf, typename Join>
+auto Async::Parallel::SplitJoin<R, Leaf, Join>::complete(Scheduler::Context ctx, std::shared_ptr<Node> node, Side side, R value) -> void {
+    while (node != nullptr) {
+        (side == Side::Left ? node->left : node->right) = std::move(value);
+        if (!node->has_sibling_result.exchange(true, std::memory_order_acq_rel)) { return; }
+
+        value = join(node->begin, node->mid, node->end, std::move(node->left.value()), std::move(node->right.value()));
+        side = node->side;
+        node = node->parent;
+    }
+
+    result.complete(ctx, std::move(value));
+}
+
+
+template <typename F>
+auto Async::parallel_for(Scheduler::IScheduler& scheduler, size_t begin, size_t end, F func, size_t grain) -> Task<Unit> {
+    auto leaf = [func = std::move(func)](size_t chunk_begin, size_t chunk_end) {
+        for (auto i = chunk_begin; i < chunk_end; i++) { func(i); }
+        return Unit {};
+    };
+    auto join = [](size_t, size_t, size_t, Unit, Unit) { return Unit {}; };
+
+    return Parallel::SplitJoin<Unit, decltype(leaf), decltype(join)>::run(scheduler, begin, end, grain, std::move(leaf), join);
+}
+
+template <std::random_access_iterator It, std::random_access_iterator OutIt, typename F>
+auto Async::parallel_transform(Scheduler::IScheduler& scheduler, It first, It last, OutIt d_first, F func, size_t grain) -> Task<Unit> {
+    auto size = static_cast<size_t>(std::distance(first, last));
+    return parallel_for(scheduler, 0, size, [first, d_first, func = std::move(func)](size_t i) {
+        *Parallel::at(d_first, i) = func(*Parallel::at(first, i));
+    }, grain);
+}
+
+template <std::random_access_iterator It, typename T, typename Op>
+auto Async::parallel_reduce(Scheduler::IScheduler& scheduler, It first, It last, T init, Op op, size_t grain) -> Task<T> {
+    auto size = static_cast<size_t>(std::distance(first, last));
+    if (size == 0) {
+        auto source = TaskValueSource<T>(scheduler);
+        source.complete(init);
+        return source.create();
+    }
+
+    // leaves are never empty, so each leaf folds from its own first element and init is folded in once at the end
+    auto leaf = [first, op](size_t chunk_begin, size_t chunk_end) {
+        auto value = static_cast<T>(*Parallel::at(first, chunk_begin));
+        for (auto i = chunk_begin + 1; i < chunk_end; i++) { value = op(std::move(value), *Parallel::at(first, i)); }
+        return value;
+    };
+    auto join = [op](size_t, size_t, size_t, T left, T right) { return op(std::move(left), std::move(right)); };
+
+    return Parallel::SplitJoin<T, decltype(leaf), decltype(join)>::run(scheduler, 0, size, grain, std::move(leaf), std::move(join))
+        .template map<T>([init = std::move(init), op](T value) { return op(init, std::move(value)); });
+}
+
+template <std::random_access_iterator It, std::random_access_iterator OutIt, typename Op>
+auto Async::parallel_inclusive_scan(Scheduler::IScheduler& scheduler, It first, It last, OutIt d_first, Op op, size_t grain) -> Task<Unit> {
+    using Value = std::iter_value_t<OutIt>;
+    struct Chunk {
+        size_t begin;
+        size_t end;
+        Value total;
+    };
+    using Chunks = std::vector<Chunk>;
+
+    // the first pass only reads the input, each leaf totals its chunk
+    auto size = static_cast<size_t>(std::distance(first, last));
+    auto leaf = [first, op](size_t chunk_begin, size_t chunk_end) {
+        if (chunk_begin == chunk_end) { return Chunks(); }
+
+        auto total = static_cast<Value>(*Parallel::at(first, chunk_begin));
+        for (auto i = chunk_begin + 1; i < chunk_end; i++) { total = op(std::move(total), *Parallel::at(first, i)); }
+        return Chunks { Chunk { chunk_begin, chunk_end, std::move(total) } };
+    };
+    auto join = [](size_t, size_t, size_t, Chunks left, Chunks right) {
+        left.insert(left.end(), std::make_move_iterator(right.begin()), std::make_move_iterator(right.end()));
+        return left;
+    };
+
+    // the chunks are in order, there are only a handful of chunks per worker so the total preceding each chunk is computed
+    // sequentially. The second pass then scans every chunk into the output starting from the total preceding it
+    auto totals = Parallel::SplitJoin<Chunks, decltype(leaf), decltype(join)>::run(scheduler, 0, size, grain, std::move(leaf), join);
+    return totals.template bind<Unit>([scheduler = std::ref(scheduler), first, d_first, op](Chunks chunks) {
+        for (auto i = size_t(1); i < chunks.size(); i++) {
+            chunks[i].total = op(chunks[i - 1].total, std::move(chunks[i].total));
+        }
+
+        auto n_chunks = chunks.size();
+        return parallel_for(scheduler.get(), 0, n_chunks, [chunks = std::move(chunks), first, d_first, op](size_t chunk) {
+            auto chunk_first = Parallel::at(first, chunks[chunk].begin);
+            auto chunk_last = Parallel::at(first, chunks[chunk].end);
+            auto chunk_d_first = Parallel::at(d_first, chunks[chunk].begin);
+            if (chunk == 0) {
+                std::inclusive_scan(chunk_first, chunk_last, chunk_d_first, op);
+            } else {
+                std::inclusive_scan(chunk_first, chunk_last, chunk_d_first, op, chunks[chunk - 1].total);
+            }
+        });
+    });
+}
+
+template <std::random_access_iterator It, typename Compare>
+auto Async::parallel_sort(Scheduler::IScheduler& scheduler, It first, It last, Compare comp, size_t grain) -> Task<Unit> {
+    auto size = static_cast<size_t>(std::distance(first, last));
+    auto leaf = [first, comp](size_t chunk_begin, size_t chunk_end) {
+        std::sort(Parallel::at(first, chunk_begin), Parallel::at(first, chunk_end), comp);
+        return Unit {};
+    };
+    auto join = [first, comp](size_t begin, size_t mid, size_t end, Unit, Unit) {
+        std::inplace_merge(Parallel::at(first, begin), Parallel::at(first, mid), Parallel::at(first, end), comp);
+        return Unit {};
+    };
+
+    return Parallel::SplitJoin<Unit, decltype(leaf), decltype(join)>::run(scheduler, 0, size, grain, std::move(leaf), std::move(join));
+}
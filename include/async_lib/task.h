@@ -1,16 +1,24 @@
 #pragma once
 
 #include <iostream>
+#include <chrono>
 #include <functional>
+#include <utility>
 #include <memory>
+#include <ranges>
+#include <tuple>
+#include <vector>
 
 #include "async_lib/types.h"
 #include "async_lib/async_result.h"
+#include "async_lib/cancellation.h"
 #include "scheduler/scheduler_intf.h"
 #include "cell/write_once_cell.h"
 #include "cell/tracking_once_cell.h"
 #include "cell/when_any_cell.h"
 #include "cell/when_all_cell.h"
+#include "cell/when_all_reduce_cell.h"
+#include "cell/when_all_tuple_cell.h"
 
 // NOLINTBEGIN(cppcoreguidelines-macro-usage)
 #define UNUSED(x) __attribute__((unused))x
@@ -20,6 +28,11 @@ namespace Async {
     template <typename T>
     class TaskValueSource;  // see comment for TaskValueSource in task_value_source.h
 
+    template <typename T>
+    class TaskAwaiter;      // see comment for TaskAwaiter in coroutine.h
+
+    class TaskTimerSource;  // see comment for TaskTimerSource in task_timer_source.h
+
     // Task is a class that represents a task that can be awaited
     // it is simply just a wrapper around a IReadableCell and prevents direct writes to the cell
     // Abstracting over direct writes to a cell allows multiple tasks to be driven by the same underlying
@@ -29,19 +42,49 @@ namespace Async {
     private:
         template <typename Q> friend class Task;
         friend class TaskValueSource<T>;   // for exposing private Task constructor that takes a cell
+        friend class TaskAwaiter<T>;       // for awaiting the cell of the task
+
+        template <typename... Ts>
+        friend auto when_all(Scheduler::IScheduler& scheduler, Task<Ts>... tasks) -> Task<std::tuple<Ts...>>;
 
     public:
         Task(Scheduler::IScheduler& scheduler, std::function<T(void)> func);
+        Task(Scheduler::IScheduler& scheduler, Priority priority, std::function<T(void)> func);
+
+        // a task created with a token resolves to Error::Cancelled if the token is cancelled before func has run, func is
+        // then skipped. Continuations of the task inherit the token, see with_cancellation
+        Task(Scheduler::IScheduler& scheduler, CancellationToken token, std::function<T(void)> func);
 
         // bind is a method that takes a function that takes the value of the cell and returns a new task
-        // it then returns a new task that will resolve to the value of the new task
+        // it then returns a new task that will resolve to the value of the new task.
+        // func is queued as a job once this task resolves, passing Cell::Dispatch::Inline runs it on the stack of the
+        // worker that resolved this task instead (see Cell::Dispatch), which is only worthwhile for a cheap func
         template <typename G>
-        [[nodiscard]] auto bind(std::function<Task<G>(T)> func) -> Task<G>;
+        [[nodiscard]] auto bind(std::function<Task<G>(T)> func, Cell::Dispatch dispatch = Cell::Dispatch::Queued) -> Task<G>;
 
         // map is a method that takes a function and applies it to the value of the cell
-        // it then returns a new task that will resolve to the result of the function
+        // it then returns a new task that will resolve to the result of the function, dispatch is as for bind
         template <typename G>
-        [[nodiscard]] auto map(std::function<G(T)> func) -> Task<G>;
+        [[nodiscard]] auto map(std::function<G(T)> func, Cell::Dispatch dispatch = Cell::Dispatch::Queued) -> Task<G>;
+
+        // continuations run at the priority of the job that resolved their parent, this overload of map runs
+        // func at the given priority instead (which will also be the priority of any continuation of the result)
+        template <typename G>
+        [[nodiscard]] auto map(Priority priority, std::function<G(T)> func, Cell::Dispatch dispatch = Cell::Dispatch::Queued) -> Task<G>;
+
+        // with_cancellation returns a task that resolves to the value of this task, or to Error::Cancelled if the token is
+        // cancelled first. The token is inherited by continuations (map/bind) of the returned task, a continuation that has
+        // not resolved by the time the token is cancelled resolves to Error::Cancelled and its func is skipped if it has
+        // not yet run. reclaim is invoked upon cancellation to release whatever drives this task (ie. a timer) early,
+        // note that cancellation does not otherwise touch this task, it keeps running to completion
+        [[nodiscard]] auto with_cancellation(CancellationToken token, std::function<void()> reclaim = nullptr) -> Task<T>;
+
+        // with_timeout returns a task that resolves to the value of this task, or to Error::Timeout if this task has not
+        // resolved within the timeout. A single timer is scheduled on the timing wheel and it is removed (in constant time)
+        // as soon as this task resolves. with_deadline is the same for an absolute point in time, these are defined
+        // alongside TaskTimerSource (see task_timer_source.h)
+        [[nodiscard]] auto with_timeout(TaskTimerSource& timers, std::chrono::milliseconds timeout) -> Task<T>;
+        [[nodiscard]] auto with_deadline(TaskTimerSource& timers, std::chrono::system_clock::time_point deadline) -> Task<T>;
 
         // block will pause the current thread until the value of the cell is available
         // it will then return the value of the cell.
@@ -55,21 +98,55 @@ namespace Async {
         // in a final vector whose order matches the order of the tasks
         [[nodiscard]] static auto when_all(Scheduler::IScheduler& scheduler, std::vector<Task<T>> tasks) -> Task<std::vector<T>>;
 
+        // when_all_shared is when_all for large results, the vector is shared by every continuation (and block) of the
+        // returned task rather than copied into each of them
+        [[nodiscard]] static auto when_all_shared(Scheduler::IScheduler& scheduler, std::vector<Task<T>> tasks) -> Task<std::shared_ptr<const std::vector<T>>>;
+
+        // when_all_reduce resolves to the fold of the values of the tasks (or to the first error) once all of them have
+        // resolved, each value is folded as soon as it arrives into a per-worker accumulator and so the memory held does
+        // not grow with the number of tasks. combine(Acc, T) -> Acc folds a value and combine(Acc, Acc) -> Acc merges the
+        // per-worker accumulators, it must be associative and commutative and identity must be its identity (ie. 0 for a
+        // sum) as every accumulator starts out as a copy of it. The tasks are not kept alive by the returned task
+        template <typename Acc, typename Combine>
+        [[nodiscard]] static auto when_all_reduce(Scheduler::IScheduler& scheduler, std::vector<Task<T>> tasks, Acc identity, Combine combine) -> Task<Acc>;
+
+        // blocking creates a task whose function runs on the scheduler's blocking pool rather than on a worker, it is
+        // intended for functions that block their thread (ie. blocking syscalls), continuations of the task run on the workers
+        [[nodiscard]] static auto blocking(Scheduler::IScheduler& scheduler, std::function<T(void)> func) -> Task<T>;
+
     protected:
         // ICell are an implementation detail so creation of Tasks from them is restricted
         // to be exclusively a private constructor
-        Task(Scheduler::IScheduler& scheduler, std::shared_ptr<Cell::ICell<T, Async::Error>> cell) : 
-            scheduler(scheduler), cell(std::move(cell)) {}
+        Task(Scheduler::IScheduler& scheduler, std::shared_ptr<Cell::ICell<T, Async::Error>> cell, CancellationToken token = {}) : 
+            scheduler(scheduler), cell(std::move(cell)), token(std::move(token)) {}
         
     private:
         static auto task_list_to_cell_list(std::vector<Task<T>> tasks) -> std::vector<std::shared_ptr<Cell::ICell<T, Async::Error>>>;
 
+        // cancel_on errors cell with Error::Cancelled (and invokes reclaim) once token is cancelled, the returned
+        // registration must be held until the cell has been resolved. It is empty for a token that cannot be cancelled
+        template <typename G>
+        [[nodiscard]] static auto cancel_on(const CancellationToken& token, const std::shared_ptr<Cell::WriteOnceCell<G, Async::Error>>& cell, 
+                                            std::function<void()> reclaim = nullptr) -> CancellationRegistration;
+
+        template <typename G>
+        static auto forward(Scheduler::Context ctx, Cell::WriteOnceCell<G, Async::Error>& cell, Cell::Result<G, Async::Error> result) -> void;
+
+        template <typename G>
+        static auto apply(Scheduler::Context ctx, Cell::WriteOnceCell<G, Async::Error>& cell, const std::function<G(T)>& func, Cell::Result<T, Async::Error> value) -> void;
+
         //  Note: it is an invariant of the Asynchronous library that the scheduler's
         //        lifetime is longer than the lifetime of any task / cell that uses it.
         //        in the application scope it has a 'static lifetime
         std::reference_wrapper<Scheduler::IScheduler> scheduler;
         std::shared_ptr<Cell::ICell<T, Async::Error>> cell;
+        CancellationToken token;
     };
+
+    // when_all over tasks of differing types, resolves to a tuple of their values (in the order of the tasks) once all
+    // of them have resolved or to the first error. The values are moved into the tuple rather than copied
+    template <typename... Ts>
+    [[nodiscard]] auto when_all(Scheduler::IScheduler& scheduler, Task<Ts>... tasks) -> Task<std::tuple<Ts...>>;
 }
 
 
@@ -79,14 +156,30 @@ namespace Async {
 
 // Implementation
 template <typename T>
-Async::Task<T>::Task(Scheduler::IScheduler& scheduler, std::function<T(void)> func) : scheduler(scheduler) {
-    auto cell = std::make_shared<Cell::WriteOnceCell<T, Async::Error>>(scheduler);
+Async::Task<T>::Task(Scheduler::IScheduler& scheduler, std::function<T(void)> func) :
+    Task(scheduler, Priority::Normal, std::move(func)) {}
+
+template <typename T>
+Async::Task<T>::Task(Scheduler::IScheduler& scheduler, Priority priority, std::function<T(void)> func) : scheduler(scheduler) {
+    auto cell = Cell::make_cell<Cell::WriteOnceCell<T, Async::Error>>(scheduler);
+    this->cell = cell;
+    this->scheduler.get().queue(
+        Scheduler::Context::empty(priority),
+        [cell, func = std::move(func)](auto ctx) {
+            cell->write(ctx, func());
+        }
+    );
+}
+
+template <typename T>
+Async::Task<T>::Task(Scheduler::IScheduler& scheduler, CancellationToken token, std::function<T(void)> func) : scheduler(scheduler), token(std::move(token)) {
+    auto cell = Cell::make_cell<Cell::WriteOnceCell<T, Async::Error>>(scheduler);
     this->cell = cell;
     this->scheduler.get().queue(
         Scheduler::Context::empty(),
-        [cell, func](auto ctx) {
-            auto result = func();
-            cell->write(ctx, result);
+        [cell, func = std::move(func), registration = cancel_on(this->token, cell)](auto ctx) {
+            if (registration.is_cancelled()) { return; }
+            cell->write(ctx, func());
         }
     );
 }
@@ -110,13 +203,34 @@ Async::Task<T>::Task(Scheduler::IScheduler& scheduler, std::function<T(void)> fu
 // intermediate child cells are still alive
 template <typename T>
 template <typename G>
-auto Async::Task<T>::bind(std::function<Task<G>(T)> func) -> Task<G> {
-    auto tracking_cell = std::make_shared<Cell::TrackingOnceCell<G, Async::Error>>();
-    auto error_cell = std::make_shared<Cell::WriteOnceCell<G, Async::Error>>(scheduler);
+auto Async::Task<T>::bind(std::function<Task<G>(T)> func, Cell::Dispatch dispatch) -> Task<G> {
+    if (token.can_be_cancelled()) {
+        // a cancellable bind cannot hand its result over to a tracking cell as it must be able to error its result itself,
+        // the result of the bound task is forwarded instead. The registration moves along with the continuation as the
+        // bind remains cancellable until the bound task resolves
+        auto cell = Cell::make_cell<Cell::WriteOnceCell<G, Async::Error>>(scheduler);
+        auto callback = [cell, func = std::move(func), registration = cancel_on(token, cell)](auto ctx, Cell::Result<T, Async::Error> value) mutable {
+            if (registration.is_cancelled()) { return; }
+            Cell::visit_result(std::move(value),
+                [&](T value) {
+                    func(std::move(value)).cell->await([cell, registration = std::move(registration)](auto ctx, Cell::Result<G, Async::Error> result) {
+                        forward(ctx, *cell, std::move(result));
+                    }, Cell::Dispatch::Inline);
+                },
+                [&](Async::Error err) { cell->error(ctx, err); });
+        };
+
+        static_assert(Cell::Callback<T, Async::Error>::template stored_inline<decltype(callback)>, "bind continuations must not allocate");
+        this->cell->await(std::move(callback), dispatch);
+        return { scheduler, cell, token };
+    }
+
+    auto tracking_cell = Cell::make_cell<Cell::TrackingOnceCell<G, Async::Error>>(scheduler);
+    auto error_cell = Cell::make_cell<Cell::WriteOnceCell<G, Async::Error>>(scheduler);
 
-    auto callback = [tracking_cell, error_cell, func](auto ctx, Cell::Result<T, Async::Error> value) {
-        auto cell_to_track = Cell::map_result(value, 
-            [func](T value) { return func(value).cell; },
+    auto callback = [tracking_cell, error_cell, func = std::move(func)](auto ctx, Cell::Result<T, Async::Error> value) {
+        auto cell_to_track = Cell::map_result(std::move(value), 
+            [&func](T value) { return func(std::move(value)).cell; },
             [ctx, error_cell](Async::Error err) { 
                 error_cell->error(ctx, err);
                 return std::static_pointer_cast<Cell::ICell<G, Async::Error>>(error_cell);
@@ -126,34 +240,131 @@ auto Async::Task<T>::bind(std::function<Task<G>(T)> func) -> Task<G> {
         tracking_cell->track(cell_to_track);
     };
 
-    this->cell->await(callback);
+    static_assert(Cell::Callback<T, Async::Error>::template stored_inline<decltype(callback)>, "bind continuations must not allocate");
+    this->cell->await(std::move(callback), dispatch);
     return { scheduler, tracking_cell };
 }
 
 
 // map can be implemented rather simply as a invocation of bind
 // however for efficiency reasons we do not do this and instead 
-// implement map using a WORM cell
+// implement map using a WORM cell, the registration is empty unless this task is cancellable
 template <typename T>
 template <typename G>
-auto Async::Task<T>::map(std::function<G(T)> func) -> Task<G> {
-    auto cell = std::make_shared<Cell::WriteOnceCell<G, Async::Error>>(scheduler);
-    auto callback = [cell, func](auto ctx, Cell::Result<T, Async::Error> value) {
-        Cell::visit_result(value, 
-            [cell, func, ctx](T value) { cell->write(ctx, func(value)); },
-            [cell, ctx](Async::Error err) { cell->error(ctx, err); });
+auto Async::Task<T>::map(std::function<G(T)> func, Cell::Dispatch dispatch) -> Task<G> {
+    auto cell = Cell::make_cell<Cell::WriteOnceCell<G, Async::Error>>(scheduler);
+    auto callback = [cell, func = std::move(func), registration = cancel_on(token, cell)](auto ctx, Cell::Result<T, Async::Error> value) {
+        if (registration.is_cancelled()) { return; }
+        apply(ctx, *cell, func, std::move(value));
     };
 
-    this->cell->await(callback);
+    static_assert(Cell::Callback<T, Async::Error>::template stored_inline<decltype(callback)>, "map continuations must not allocate");
+    this->cell->await(std::move(callback), dispatch);
+    return { scheduler, cell, token };
+}
+
+
+// map at a priority runs func inline if the parent was resolved at the requested priority, otherwise the
+// application of func is queued as a job of the requested priority. A cancellable map at a priority does not
+// fit a registration in the continuation's inline buffer, so its continuation is boxed
+template <typename T>
+template <typename G>
+auto Async::Task<T>::map(Priority priority, std::function<G(T)> func, Cell::Dispatch dispatch) -> Task<G> {
+    auto cell = Cell::make_cell<Cell::WriteOnceCell<G, Async::Error>>(scheduler);
+    if (token.can_be_cancelled()) {
+        this->cell->await([cell, func = std::move(func), scheduler = scheduler, priority, registration = cancel_on(token, cell)](auto ctx, Cell::Result<T, Async::Error> value) mutable {
+            if (registration.is_cancelled()) { return; }
+            if (ctx.priority() == priority) { 
+                apply(ctx, *cell, func, std::move(value));
+                return;
+            }
+
+            scheduler.get().queue(ctx.with_priority(priority), [cell, func = std::move(func), value = std::move(value), registration = std::move(registration)](auto ctx) mutable {
+                if (registration.is_cancelled()) { return; }
+                apply(ctx, *cell, func, std::move(value));
+            });
+        }, dispatch);
+
+        return { scheduler, cell, token };
+    }
+
+    auto callback = [cell, func = std::move(func), scheduler = scheduler, priority](auto ctx, Cell::Result<T, Async::Error> value) mutable {
+        if (ctx.priority() == priority) {
+            apply(ctx, *cell, func, std::move(value));
+            return;
+        }
+
+        scheduler.get().queue(ctx.with_priority(priority), [cell, func = std::move(func), value = std::move(value)](auto ctx) mutable { apply(ctx, *cell, func, std::move(value)); });
+    };
+
+    static_assert(Cell::Callback<T, Async::Error>::template stored_inline<decltype(callback)>, "map continuations must not allocate");
+    this->cell->await(std::move(callback), dispatch);
     return { scheduler, cell };
 }
 
 
+// with_cancellation forwards this task's result into a cell of its own, the forwarding continuation holds the
+// registration so that it is released as soon as this task resolves
+template <typename T>
+auto Async::Task<T>::with_cancellation(CancellationToken token, std::function<void()> reclaim) -> Task<T> {
+    if (!token.can_be_cancelled()) { return *this; }
+
+    auto cell = Cell::make_cell<Cell::WriteOnceCell<T, Async::Error>>(scheduler);
+    auto callback = [cell, registration = cancel_on(token, cell, std::move(reclaim))](auto ctx, Cell::Result<T, Async::Error> value) {
+        forward(ctx, *cell, std::move(value));
+    };
+
+    static_assert(Cell::Callback<T, Async::Error>::template stored_inline<decltype(callback)>, "forwarding continuations must not allocate");
+    this->cell->await(std::move(callback), Cell::Dispatch::Inline);
+    return { scheduler, cell, std::move(token) };
+}
+
+
+// the cancellation callback only holds a weak reference to the cell, a cell whose continuation chain has been
+// dropped is not kept alive by its registration
+template <typename T>
+template <typename G>
+auto Async::Task<T>::cancel_on(const CancellationToken& token, const std::shared_ptr<Cell::WriteOnceCell<G, Async::Error>>& cell,
+                               std::function<void()> reclaim) -> CancellationRegistration {
+    if (!token.can_be_cancelled()) { return {}; }
+
+    return token.on_cancel([cell = std::weak_ptr(cell), reclaim = std::move(reclaim)]() {
+        if (auto cancelled = cell.lock(); cancelled != nullptr) { cancelled->error(Async::Error::Cancelled); }
+        if (reclaim) { reclaim(); }
+    });
+}
+
+template <typename T>
+template <typename G>
+auto Async::Task<T>::forward(Scheduler::Context ctx, Cell::WriteOnceCell<G, Async::Error>& cell, Cell::Result<G, Async::Error> result) -> void {
+    Cell::visit_result(std::move(result),
+        [&cell, ctx](G value) { cell.write(ctx, std::move(value)); },
+        [&cell, ctx](Async::Error err) { cell.error(ctx, err); });
+}
+
+template <typename T>
+template <typename G>
+auto Async::Task<T>::apply(Scheduler::Context ctx, Cell::WriteOnceCell<G, Async::Error>& cell, const std::function<G(T)>& func, Cell::Result<T, Async::Error> value) -> void {
+    Cell::visit_result(std::move(value),
+        [&cell, &func, ctx](T value) { cell.write(ctx, func(std::move(value))); },
+        [&cell, ctx](Async::Error err) { cell.error(ctx, err); });
+}
+
+
+template <typename T>
+auto Async::Task<T>::blocking(Scheduler::IScheduler& scheduler, std::function<T(void)> func) -> Task<T> {
+    auto cell = Cell::make_cell<Cell::WriteOnceCell<T, Async::Error>>(scheduler);
+    scheduler.queue_blocking([cell, func = std::move(func)](auto ctx) {
+        cell->write(ctx, func());
+    });
+
+    return { scheduler, cell };
+}
+
 template <typename T>
 auto Async::Task<T>::block() -> Async::Result<T> {
-    auto cell_result = this->cell->block();
-    return Cell::map_result(cell_result, 
-        [](T value) { return Async::Result<T> { value }; },
+    return Cell::map_result(this->cell->block(), 
+        [](T value) { return Async::Result<T> { std::move(value) }; },
         [](Async::Error err) { return Async::Result<T> { err }; });
 }
 
@@ -171,7 +382,7 @@ auto Async::Task<T>::task_list_to_cell_list(std::vector<Task<T>> tasks) -> std::
 template <typename T>
 auto Async::Task<T>::when_any(Scheduler::IScheduler& scheduler, std::vector<Task<T>> tasks) -> Task<T> {
     auto cells = task_list_to_cell_list(tasks);
-    auto when_any_cell = std::make_shared<Cell::WhenAnyCell<T, Async::Error>>(scheduler, cells);
+    auto when_any_cell = Cell::make_cell<Cell::WhenAnyCell<T, Async::Error>>(scheduler, cells);
     return { scheduler, when_any_cell };
 }
 
@@ -179,6 +390,31 @@ auto Async::Task<T>::when_any(Scheduler::IScheduler& scheduler, std::vector<Task
 template <typename T>
 auto Async::Task<T>::when_all(Scheduler::IScheduler& scheduler, std::vector<Task<T>> tasks) -> Task<std::vector<T>> {
     auto cells = task_list_to_cell_list(tasks);
-    auto when_all_cell = std::make_shared<Cell::WhenAllCell<T, Async::Error>>(scheduler, cells);
+    auto when_all_cell = Cell::make_cell<Cell::WhenAllCell<T, Async::Error>>(scheduler, cells);
+    return { scheduler, when_all_cell };
+}
+
+template <typename T>
+auto Async::Task<T>::when_all_shared(Scheduler::IScheduler& scheduler, std::vector<Task<T>> tasks) -> Task<std::shared_ptr<const std::vector<T>>> {
+    auto cells = task_list_to_cell_list(tasks);
+    auto when_all_cell = Cell::make_cell<Cell::WhenAllCell<T, Async::Error, std::shared_ptr<const std::vector<T>>>>(scheduler, cells);
+    return { scheduler, when_all_cell };
+}
+
+
+template <typename T>
+template <typename Acc, typename Combine>
+auto Async::Task<T>::when_all_reduce(Scheduler::IScheduler& scheduler, std::vector<Task<T>> tasks, Acc identity, Combine combine) -> Task<Acc> {
+    auto cells = tasks | std::views::transform(&Task<T>::cell);
+    auto when_all_reduce_cell = Cell::make_cell<Cell::WhenAllReduceCell<T, Async::Error, Acc, Combine>>(scheduler, cells, std::move(identity), std::move(combine));
+    return { scheduler, when_all_reduce_cell };
+}
+
+
+template <typename... Ts>
+auto Async::when_all(Scheduler::IScheduler& scheduler, Task<Ts>... tasks) -> Task<std::tuple<Ts...>> {
+    static_assert(sizeof...(Ts) > 0, "when_all requires at least one task");
+
+    auto when_all_cell = Cell::make_cell<Cell::WhenAllTupleCell<std::tuple<Ts...>, Async::Error>>(scheduler, std::move(tasks.cell)...);
     return { scheduler, when_all_cell };
 }
\ No newline at end of file
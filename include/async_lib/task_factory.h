@@ -2,16 +2,22 @@
 
 #include <memory>
 #include <functional>
+#include <tuple>
+#include <utility>
 
 #include "scheduler/scheduler_factory.h"
 #include "async_lib/task_io_source.h"
 #include "async_lib/task_timer_source.h"
+#include "async_lib/parallel.h"
 #include "task_value_source.h"
 #include "task.h"
 
 namespace Async {
     namespace IO = ::IO;
 
+    template <typename T>
+    class TaskPromise;      // see comment for TaskPromise in coroutine.h
+
     // TaskFactory exists for the sole purpose of tying together the various components of the Async
     // library to a singular scheduler instance, it is mostly a convenience class and does not need to be used
     // if not required. It should be noted however that if one is not using this class, ideally they should be threading
@@ -19,6 +25,7 @@ namespace Async {
     class TaskFactory {
     public:
         explicit TaskFactory(int n_workers);
+        explicit TaskFactory(const Scheduler::SchedulerConfig& config);
 
         template <typename T>
         [[nodiscard]] auto value_source() -> TaskValueSource<T>;
@@ -28,13 +35,58 @@ namespace Async {
         template <typename T>
         [[nodiscard]] auto create(std::function<T(void)> function) -> Task<T>;
 
+        // creates a task whose function (and by default its continuations) runs at the given priority
+        template <typename T>
+        [[nodiscard]] auto create(Priority priority, std::function<T(void)> function) -> Task<T>;
+
+        // creates a task whose function is skipped if the token is cancelled before it runs, see async_lib/cancellation.h
+        template <typename T>
+        [[nodiscard]] auto create(CancellationToken token, std::function<T(void)> function) -> Task<T>;
+
+        // creates a task whose function runs on the scheduler's blocking pool, see Task::blocking
+        template <typename T>
+        [[nodiscard]] auto create_blocking(std::function<T(void)> function) -> Task<T>;
+
         template <typename T>
         [[nodiscard]] auto when_any(std::vector<Task<T>> tasks) -> Task<T>;
 
         template <typename T>
         [[nodiscard]] auto when_all(std::vector<Task<T>> tasks) -> Task<std::vector<T>>;
 
+        template <typename T>
+        [[nodiscard]] auto when_all_shared(std::vector<Task<T>> tasks) -> Task<std::shared_ptr<const std::vector<T>>>;
+
+        // folds the values of the tasks as they arrive, see Task::when_all_reduce
+        template <typename T, typename Acc, typename Combine>
+        [[nodiscard]] auto when_all_reduce(std::vector<Task<T>> tasks, Acc identity, Combine combine) -> Task<Acc>;
+
+        // when_all over tasks of differing types, see Async::when_all. It takes at least two tasks so that
+        // when_all<T>({ task }) still resolves to a vector
+        template <typename... Ts> requires (sizeof...(Ts) > 1)
+        [[nodiscard]] auto when_all(Task<Ts>... tasks) -> Task<std::tuple<Ts...>>;
+
+        // parallel algorithms over the factory's scheduler, see async_lib/parallel.h
+        template <typename F>
+        [[nodiscard]] auto parallel_for(size_t begin, size_t end, F func, size_t grain = 1) -> Task<Unit>;
+
+        template <std::random_access_iterator It, std::random_access_iterator OutIt, typename F>
+        [[nodiscard]] auto parallel_transform(It first, It last, OutIt d_first, F func, size_t grain = 1) -> Task<Unit>;
+
+        template <std::random_access_iterator It, typename T, typename Op = std::plus<>>
+        [[nodiscard]] auto parallel_reduce(It first, It last, T init, Op op = {}, size_t grain = 1) -> Task<T>;
+
+        template <std::random_access_iterator It, std::random_access_iterator OutIt, typename Op = std::plus<>>
+        [[nodiscard]] auto parallel_inclusive_scan(It first, It last, OutIt d_first, Op op = {}, size_t grain = 1) -> Task<Unit>;
+
+        template <std::random_access_iterator It, typename Compare = std::less<>>
+        [[nodiscard]] auto parallel_sort(It first, It last, Compare comp = {}, size_t grain = 1) -> Task<Unit>;
+
+        // metrics takes a snapshot of the underlying scheduler's metrics, see scheduler/metrics.h
+        [[nodiscard]] auto metrics() const -> Scheduler::SchedulerMetrics { return scheduler->metrics(); }
+
     private:
+        template <typename T> friend class TaskPromise;     // coroutines taking a TaskFactory run on its scheduler
+
         std::shared_ptr<Timing::PollSource> timing_poll_source;
         std::shared_ptr<IO::PollSource> io_poll_source;
         std::unique_ptr<Scheduler::IScheduler> scheduler;
@@ -50,6 +102,12 @@ inline Async::TaskFactory::TaskFactory(int n_workers) :
     scheduler(Scheduler::create_scheduler(n_workers, { timing_poll_source, io_poll_source }))
 {}
 
+inline Async::TaskFactory::TaskFactory(const Scheduler::SchedulerConfig& config) :
+    timing_poll_source(std::make_shared<Timing::PollSource>()),
+    io_poll_source(std::make_shared<IO::PollSource>()),
+    scheduler(Scheduler::create_scheduler(config, { timing_poll_source, io_poll_source }))
+{}
+
 template <typename T>
 auto inline Async::TaskFactory::value_source() -> TaskValueSource<T> {
     return TaskValueSource<T>(*scheduler);
@@ -69,6 +127,21 @@ auto Async::TaskFactory::create(std::function<T(void)> function) -> Task<T> {
     return { *scheduler, function };
 }
 
+template <typename T>
+auto Async::TaskFactory::create(Priority priority, std::function<T(void)> function) -> Task<T> {
+    return { *scheduler, priority, std::move(function) };
+}
+
+template <typename T>
+auto Async::TaskFactory::create(CancellationToken token, std::function<T(void)> function) -> Task<T> {
+    return { *scheduler, std::move(token), std::move(function) };
+}
+
+template <typename T>
+auto Async::TaskFactory::create_blocking(std::function<T(void)> function) -> Task<T> {
+    return Task<T>::blocking(*scheduler, std::move(function));
+}
+
 template <typename T>
 auto Async::TaskFactory::when_any(std::vector<Task<T>> tasks) -> Task<T> {
     return Task<T>::when_any(*scheduler, tasks); 
@@ -76,5 +149,45 @@ auto Async::TaskFactory::when_any(std::vector<Task<T>> tasks) -> Task<T> {
 
 template <typename T>
 auto Async::TaskFactory::when_all(std::vector<Task<T>> tasks) -> Task<std::vector<T>> {
-    return Task<T>::when_all(*scheduler, tasks); 
-}
\ No newline at end of file
+    return Task<T>::when_all(*scheduler, std::move(tasks)); 
+}
+
+template <typename T>
+auto Async::TaskFactory::when_all_shared(std::vector<Task<T>> tasks) -> Task<std::shared_ptr<const std::vector<T>>> {
+    return Task<T>::when_all_shared(*scheduler, std::move(tasks)); 
+}
+
+template <typename T, typename Acc, typename Combine>
+auto Async::TaskFactory::when_all_reduce(std::vector<Task<T>> tasks, Acc identity, Combine combine) -> Task<Acc> {
+    return Task<T>::when_all_reduce(*scheduler, std::move(tasks), std::move(identity), std::move(combine));
+}
+
+template <typename... Ts> requires (sizeof...(Ts) > 1)
+auto Async::TaskFactory::when_all(Task<Ts>... tasks) -> Task<std::tuple<Ts...>> {
+    return Async::when_all(*scheduler, std::move(tasks)...);
+}
+
+template <typename F>
+auto Async::TaskFactory::parallel_for(size_t begin, size_t end, F func, size_t grain) -> Task<Unit> {
+    return Async::parallel_for(*scheduler, begin, end, std::move(func), grain);
+}
+
+template <std::random_access_iterator It, std::random_access_iterator OutIt, typename F>
+auto Async::TaskFactory::parallel_transform(It first, It last, OutIt d_first, F func, size_t grain) -> Task<Unit> {
+    return Async::parallel_transform(*scheduler, first, last, d_first, std::move(func), grain);
+}
+
+template <std::random_access_iterator It, typename T, typename Op>
+auto Async::TaskFactory::parallel_reduce(It first, It last, T init, Op op, size_t grain) -> Task<T> {
+    return Async::parallel_reduce(*scheduler, first, last, std::move(init), std::move(op), grain);
+}
+
+template <std::random_access_iterator It, std::random_access_iterator OutIt, typename Op>
+auto Async::TaskFactory::parallel_inclusive_scan(It first, It last, OutIt d_first, Op op, size_t grain) -> Task<Unit> {
+    return Async::parallel_inclusive_scan(*scheduler, first, last, d_first, std::move(op), grain);
+}
+
+template <std::random_access_iterator It, typename Compare>
+auto Async::TaskFactory::parallel_sort(It first, It last, Compare comp, size_t grain) -> Task<Unit> {
+    return Async::parallel_sort(*scheduler, first, last, std::move(comp), grain);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "async_lib/task_value_source.h"
+#include "async_lib/cancellation.h"
 #include "scheduler/scheduler_intf.h"
 #include "io/io_poll_source.h"
 
@@ -14,6 +15,10 @@ namespace Async {
 
         auto read(FILE* file, IO::ReadRequest request) -> Async::Task<IO::ReadRequest>;
 
+        // the read of a task created with a token is aio_cancelled once the token is cancelled, releasing its buffer,
+        // the task then resolves to Error::Cancelled
+        auto read(FILE* file, IO::ReadRequest request, CancellationToken token) -> Async::Task<IO::ReadRequest>;
+
     private:
         // Note:
         //      It is expected that the lifetime of the scheduler is longer than the lifetime of the TaskIOSource
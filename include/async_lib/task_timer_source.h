@@ -1,10 +1,17 @@
+#pragma once
+
 #include <iostream>
+#include <algorithm>
 #include <chrono>
+#include <memory>
 #include <mutex>
 
 #include "task_value_source.h"
+#include "cancellation.h"
 #include "scheduler/scheduler_intf.h"
 #include "types.h"
+#include "task.h"
+#include "cell/write_once_cell.h"
 #include "timing/timing_poll_source.h"
 
 
@@ -19,7 +26,13 @@ namespace Async {
         // create creates a new task that is resolved after the specified duration
         auto after(std::chrono::milliseconds duration) -> Async::Task<Unit>;
 
+        // the timer of a task created with a token is removed from the timing wheel once the token is cancelled,
+        // the task then resolves to Error::Cancelled
+        auto after(std::chrono::milliseconds duration, CancellationToken token) -> Async::Task<Unit>;
+
     private:
+        template <typename T> friend class Task;    // Task::with_timeout schedules its timer directly on the wheel
+
         // Note:
         //      It is expected that the lifetime of the scheduler is longer than the lifetime of the TaskTimerSource
         //      the scheduler's lifetime should match the entire application lifetime.
@@ -30,4 +43,36 @@ namespace Async {
         std::reference_wrapper<Scheduler::IScheduler> scheduler;
         std::reference_wrapper<Timing::PollSource> timing_poll_source;
     };
-}
\ No newline at end of file
+}
+
+
+
+
+
+
+// Implementation
+// with_timeout forwards the task's result into a cell of its own which the timer errors upon expiry, the forwarding
+// continuation removes the timer from the wheel. If the task is cancellable so is its timeout, cancelling it removes the
+// timer as well
+template <typename T>
+auto Async::Task<T>::with_timeout(TaskTimerSource& timers, std::chrono::milliseconds timeout) -> Task<T> {
+    auto cell = Cell::make_cell<Cell::WriteOnceCell<T, Async::Error>>(scheduler);
+    auto& timing_poll_source = timers.timing_poll_source.get();
+    auto timer = timing_poll_source.schedule(timeout, [cell](auto ctx) { cell->error(ctx, Async::Error::Timeout); });
+
+    auto reclaim = [&timing_poll_source, timer]() { static_cast<void>(timing_poll_source.cancel(timer)); };
+    auto callback = [cell, reclaim, registration = cancel_on(token, cell, reclaim)](auto ctx, Cell::Result<T, Async::Error> value) {
+        reclaim();
+        forward(ctx, *cell, std::move(value));
+    };
+
+    static_assert(Cell::Callback<T, Async::Error>::template stored_inline<decltype(callback)>, "timeout continuations must not allocate");
+    this->cell->await(std::move(callback), Cell::Dispatch::Inline);
+    return { scheduler, cell, token };
+}
+
+template <typename T>
+auto Async::Task<T>::with_deadline(TaskTimerSource& timers, std::chrono::system_clock::time_point deadline) -> Task<T> {
+    auto timeout = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::system_clock::now());
+    return with_timeout(timers, std::max(timeout, std::chrono::milliseconds(0)));
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <utility>
 
 #include "async_lib/task.h"
 #include "async_lib/async_result.h"
@@ -40,7 +41,7 @@ namespace Async {
 // Implementation
 template <typename T>
 Async::TaskValueSource<T>::TaskValueSource(Scheduler::IScheduler& scheduler) : scheduler(scheduler) {
-    this->task_cell = std::make_shared<Cell::WriteOnceCell<T, Async::Error>>(scheduler);
+    this->task_cell = Cell::make_cell<Cell::WriteOnceCell<T, Async::Error>>(scheduler);
 }
 
 template <typename T>
@@ -55,12 +56,12 @@ auto Async::TaskValueSource<T>::error(Scheduler::Context ctx, Async::Error error
 
 template <typename T>
 auto Async::TaskValueSource<T>::complete(T value) -> void {
-    this->task_cell->write(value);
+    this->task_cell->write(std::move(value));
 }
 
 template <typename T>
 auto Async::TaskValueSource<T>::complete(Scheduler::Context ctx, T value) -> void {
-    this->task_cell->write(ctx, value);
+    this->task_cell->write(ctx, std::move(value));
 }
 
 template <typename T>
@@ -3,6 +3,11 @@
 #include <variant>
 #include <functional>
 
+#include "scheduler/scheduling_context.h"
+
 namespace Async {
     using Unit = std::monostate;
+
+    // Priority is the priority class tasks are scheduled at, see Scheduler::Priority
+    using Priority = Scheduler::Priority;
 }
@@ -0,0 +1,88 @@
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "async_lib/cancellation.h"
+#include "concurrency/slab_allocator.h"
+#include "concurrency/spinlock.h"
+
+using Node = Async::Cancellation::Node;
+
+Async::CancellationSource::CancellationSource() :
+    state(std::allocate_shared<Cancellation::State>(SlabAllocator<Cancellation::State>())) {}
+
+// the callbacks are destroyed as soon as they have been invoked (rather than with their registrations) as they may
+// well own the last reference to a cell
+auto Async::CancellationSource::cancel() const -> bool {
+    auto* nodes = static_cast<Node*>(nullptr);
+    {
+        const std::lock_guard<SpinLock> lock(state->spinlock);
+        if (state->cancelled.load(std::memory_order_relaxed)) { return false; }
+
+        state->cancelled.store(true, std::memory_order_release);
+        nodes = std::exchange(state->head, nullptr);
+    }
+
+    while (nodes != nullptr) {
+        auto node = std::move(nodes->self);
+        nodes = node->next;
+        node->callback();
+        node->callback = nullptr;
+    }
+
+    return true;
+}
+
+auto Async::CancellationToken::on_cancel(CancellationCallback callback) const -> CancellationRegistration {
+    if (state == nullptr) { return {}; }
+
+    auto node = std::allocate_shared<Node>(SlabAllocator<Node>(), std::move(callback), state, nullptr, nullptr, nullptr);
+    {
+        const std::lock_guard<SpinLock> lock(state->spinlock);
+        if (!state->cancelled.load(std::memory_order_relaxed)) {
+            node->self = node;
+            node->next = state->head;
+            if (state->head != nullptr) { state->head->prev = node.get(); }
+            state->head = node.get();
+            return CancellationRegistration(std::move(node));
+        }
+    }
+
+    // the token has already been cancelled, the registration still reports the cancellation
+    node->callback();
+    node->callback = nullptr;
+    return CancellationRegistration(std::move(node));
+}
+
+auto Async::CancellationRegistration::operator=(CancellationRegistration&& other) noexcept -> CancellationRegistration& {
+    if (this != &other) {
+        reset();
+        node = std::move(other.node);
+    }
+
+    return *this;
+}
+
+auto Async::CancellationRegistration::is_cancelled() const -> bool {
+    return node != nullptr && node->state->cancelled.load(std::memory_order_acquire);
+}
+
+// the list's reference to the node is dropped once the lock is released, destroying the callback
+auto Async::CancellationRegistration::reset() -> void {
+    if (node == nullptr) { return; }
+
+    auto& state = *node->state;
+    auto unlinked = std::shared_ptr<Node>();
+    {
+        const std::lock_guard<SpinLock> lock(state.spinlock);
+        if (!state.cancelled.load(std::memory_order_relaxed)) {
+            if (node->prev == nullptr) { state.head = node->next; } else { node->prev->next = node->next; }
+            if (node->next != nullptr) { node->next->prev = node->prev; }
+            unlinked = std::move(node->self);
+        }
+    }
+
+    unlinked.reset();
+    node.reset();
+}
@@ -6,6 +6,7 @@
 #include "async_lib/task_value_source.h"
 #include "io/io_request.h"
 #include "async_lib/async_result.h"
+#include "async_lib/cancellation.h"
 #include "io/aio_request_result.h"
 
 // NOLINTBEGIN(cppcoreguidelines-macro-usage)
@@ -14,6 +15,11 @@
 
 
 auto Async::TaskIOSource::read(FILE* file, IO::ReadRequest request) -> Async::Task<IO::ReadRequest> {
+    return read(file, std::move(request), CancellationToken());
+}
+
+// cancelling the read drops its callback and with it the value source
+auto Async::TaskIOSource::read(FILE* file, IO::ReadRequest request, CancellationToken token) -> Async::Task<IO::ReadRequest> {
     auto task_source = TaskValueSource<IO::ReadRequest>(scheduler);
     auto task = task_source.create();
     auto read_callback = [task_source](auto io_result) mutable {
@@ -23,6 +29,8 @@ auto Async::TaskIOSource::read(FILE* file, IO::ReadRequest request) -> Async::Ta
         );
     };
 
-    io_poll_source.get().queue_read(file, std::move(request), read_callback);
-    return task;
+    auto id = io_poll_source.get().queue_read(file, std::move(request), read_callback);
+    return task.with_cancellation(std::move(token), [&io_poll_source = io_poll_source.get(), id]() {
+        static_cast<void>(io_poll_source.cancel(id));
+    });
 }
\ No newline at end of file
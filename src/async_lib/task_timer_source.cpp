@@ -1,18 +1,28 @@
 #include <memory>
 #include <chrono>
 
+#include "concurrency/slab_allocator.h"
 #include "async_lib/task.h"
 #include "async_lib/task_value_source.h"
 #include "async_lib/types.h"
 #include "async_lib/task_timer_source.h"
+#include "async_lib/cancellation.h"
+#include "timing/structures/timing_wheel_hierarchical.h"
 
 auto Async::TaskTimerSource::after(std::chrono::milliseconds duration) -> Async::Task<Unit> {
-    auto value_source = std::make_shared<Async::TaskValueSource<Unit>>(scheduler);
+    return after(duration, CancellationToken());
+}
+
+// cancelling the timer destroys its job and with it the value source, hence a cancelled timer holds on to nothing
+auto Async::TaskTimerSource::after(std::chrono::milliseconds duration, CancellationToken token) -> Async::Task<Unit> {
+    auto value_source = std::allocate_shared<Async::TaskValueSource<Unit>>(SlabAllocator<Async::TaskValueSource<Unit>>(), scheduler);
     // the value source triggers after the expiry, this is achieved by
     // scheduling a task to complete the value source after the expiry
-    timing_poll_source.get().schedule(duration, [value_source](auto ctx) {
+    auto timer = timing_poll_source.get().schedule(duration, [value_source](auto ctx) {
         value_source->complete(ctx, {}); 
     });
 
-    return value_source->create();
+    return value_source->create().with_cancellation(std::move(token), [&timing_poll_source = timing_poll_source.get(), timer]() {
+        static_cast<void>(timing_poll_source.cancel(timer));
+    });
 }
\ No newline at end of file
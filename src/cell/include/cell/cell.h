@@ -1,23 +1,60 @@
 #pragma once
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <shared_mutex>
 #include <ranges>
 #include <functional>
+#include <utility>
 #include <vector>
 
+#include "concurrency/slab_allocator.h"
+#include "scheduler/inplace_function.h"
 #include "scheduler/scheduling_context.h"
 #include "cell/cell_result.h"
 
 namespace Cell {
+    // callback_capacity is the inline capacity of a continuation, it fits the captures of the continuations produced by
+    // Task::map and Task::bind (a std::function and up to two cells) without allocating
+    constexpr size_t callback_capacity = 64;
+
+    template <typename T, typename Err>
+    using Callback = Scheduler::InplaceFunction<void(Scheduler::Context, Cell::Result<T, Err>), callback_capacity>;
+
+    // Dispatch selects how a continuation is resumed once its cell is written. Queued continuations are queued onto the
+    // scheduler, an Inline continuation runs straight away on the stack of the worker that wrote the cell (if the cell is
+    // written from a worker and the worker's inline depth allows it, see IScheduler::run_inline). Inline is intended for
+    // continuations that do little more than forward their result, ie. those of when_all, when_any, with_cancellation
+    // and the hand-off of a bound task. The continuations of map and bind run user code and so are Queued unless the
+    // caller opts in to Inline
+    enum class Dispatch : uint8_t {
+        Queued,
+        Inline,
+    };
+
     template <typename T, typename Err>
-    using Callback = std::function<void(Scheduler::Context, Cell::Result<T, Err>)>;
+    struct Continuation {
+        Callback<T, Err> callback;
+        Dispatch dispatch;
+    };
+
+    // Callbacks are stored in slab allocated vectors as every pending cell holds at least one
+    template <typename T, typename Err>
+    using Callbacks = std::vector<Continuation<T, Err>, SlabAllocator<Continuation<T, Err>>>;
+
+    // make_cell allocates a cell (and its shared_ptr control block) from the calling thread's slab arena, cells
+    // are created on every continuation so all cells created by the library are allocated through make_cell
+    template <typename C, typename... Args>
+    [[nodiscard]] auto make_cell(Args&&... args) -> std::shared_ptr<C> {
+        return std::allocate_shared<C>(SlabAllocator<C>(), std::forward<Args>(args)...);
+    }
 
     template <typename T, typename Err>
     class ICell {
     public:
-        virtual auto await(Callback<T, Err> callback) -> void = 0;
+        virtual auto await(Callback<T, Err> callback, Dispatch dispatch) -> void = 0;
         [[nodiscard]] virtual auto read() const -> std::optional<Cell::Result<T, Err>> = 0;
         [[nodiscard]] virtual auto block() const -> Cell::Result<T, Err> = 0;
 
@@ -2,6 +2,7 @@
 
 #include <variant>
 #include <concepts>
+#include <utility>
 
 namespace Cell {
     template <typename T, typename Err>
@@ -10,18 +11,18 @@ namespace Cell {
     template <typename T, typename Err, std::invocable<T> IfT, std::invocable<Err> IfErr>
     auto visit_result(Result<T, Err> result, IfT visit_t, IfErr visit_err) -> void {
         if (std::holds_alternative<T>(result)) {
-            visit_t(std::get<T>(result));
+            visit_t(std::get<T>(std::move(result)));
         } else {
-            visit_err(std::get<Err>(result));
+            visit_err(std::get<Err>(std::move(result)));
         }
     }
 
     template <typename T, typename Err, std::invocable<T> IfT, std::invocable<Err> IfErr>
     auto map_result(Result<T, Err> result, IfT t_func, IfErr err_func) -> decltype(auto) {
         if (std::holds_alternative<T>(result)) {
-            return t_func(std::get<T>(result));
+            return t_func(std::get<T>(std::move(result)));
         }
 
-        return err_func(std::get<Err>(result));
+        return err_func(std::get<Err>(std::move(result)));
     }
 }
\ No newline at end of file
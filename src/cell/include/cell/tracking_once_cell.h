@@ -1,10 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <shared_mutex>
 #include <optional>
 #include <vector>
 #include <condition_variable>
 #include <functional>
+#include <memory>
+#include <utility>
 
 #include "scheduler/scheduler_intf.h"
 #include "cell.h"
@@ -17,13 +20,15 @@ namespace Cell {
     template <typename T, typename Err>
     class TrackingOnceCell : public ICell<T, Err> {
     public:
+        explicit TrackingOnceCell(Scheduler::IScheduler& scheduler) : scheduler(scheduler) {}
+
         [[nodiscard]] auto read() const -> std::optional<Cell::Result<T, Err>> override;
 
         // await takes a callback function and calls it with the value
         // of the cell being tracked when it is available, if no cell 
         // is being tracked, the callback is added to a list of callbacks
         // and added once we have a tracking cell
-        auto await(Callback<T, Err> callback) -> void override;
+        auto await(Callback<T, Err> callback, Dispatch dispatch) -> void override;
 
         // track sets the cell to track, if a cell is already being tracked
         // the function returns false, otherwise it returns true indicating a successful track
@@ -32,19 +37,29 @@ namespace Cell {
 
         // block sleeps the current thread until the value of the cell is available
         // it then returns the value of the cell, note that this is different from await
-        // as await registers a continuation, while block is a blocking operation
+        // as await registers a continuation, while block is a blocking operation.
+        // A worker blocking on an untracked cell runs other jobs until the cell is tracked (see IScheduler::help_until),
+        // it then blocks on the tracked cell which helps in turn
         [[nodiscard]] auto block() const -> Cell::Result<T, Err> override;
 
     private:
+        [[nodiscard]] auto is_tracked() const -> bool;
+
         // A note on callbacks:
         // we need to maintain a set of callbacks for the TrackingCell
         // as we may not know what cell we are tracking until much later, hence we need to
         // maintain a set of subscribers to fill once we have a cell to track
         std::optional<std::shared_ptr<ICell<T, Err>>> cell;
-        std::vector<Callback<T, Err>> callbacks;
+        Callbacks<T, Err> callbacks;
 
         mutable std::condition_variable_any cell_filled;
         mutable std::shared_mutex mutex;
+        // has_helpers is set once a worker has blocked on the cell, track must then wake the scheduler's helpers
+        mutable std::atomic<bool> has_helpers = { false };
+
+        //  Note: it is an invariant of the Asynchronous library that the scheduler's
+        //        is of 'static lifetime and hence will outlive any cell that uses it
+        std::reference_wrapper<Scheduler::IScheduler> scheduler;
     };
 }
 
@@ -62,53 +77,74 @@ auto Cell::TrackingOnceCell<T, Err>::read() const -> std::optional<Cell::Result<
 
 
 template <typename T, typename Err>
-auto Cell::TrackingOnceCell<T, Err>::await(Callback<T, Err> callback) -> void {
-    // note that we take a shared lock here to prevent lock contention, as 
-    // track is the only other fn that would use the callbacks vector (and claims a unique lock)
-    // it is impossible for both await and write to be in the critical section at the same time
-    const std::shared_lock lock(mutex);
-    if (!cell.has_value()) {
-        callbacks.push_back(callback);
-        return;
+auto Cell::TrackingOnceCell<T, Err>::await(Callback<T, Err> callback, Dispatch dispatch) -> void {
+    // concurrent awaits all push onto the callbacks vector, hence awaiting an untracked cell takes a unique lock. The
+    // tracked cell is awaited outside of the lock as it may resume the callback inline
+    auto tracked = std::shared_ptr<ICell<T, Err>>();
+    {
+        const std::unique_lock lock(mutex);
+        if (!cell.has_value()) {
+            callbacks.push_back({ std::move(callback), dispatch });
+            return;
+        }
+
+        tracked = cell.value();
     }
 
-    cell.value()->await(callback);
+    tracked->await(std::move(callback), dispatch);
 }
 
 
 template <typename T, typename Err>
 auto Cell::TrackingOnceCell<T, Err>::track(std::shared_ptr<ICell<T, Err>> new_cell) -> bool {
+    auto continuations = Callbacks<T, Err>();
     {
         const std::unique_lock lock(mutex);
         if (cell.has_value()) { return false; }
     
         cell = std::optional(new_cell);
-    
-        // alert callbacks by registering them as callbacks
-        // on the underlying cell
-        for (auto& callback : callbacks) {
-            cell.value()->await(callback);
-        }
-    
-        callbacks.clear();
+        continuations.swap(callbacks);
     }
 
     // raise the fact that the cell is filled is now true, releasing any threads waiting on this condition
     // variable
     this->cell_filled.notify_all();
+    if (has_helpers.load(std::memory_order_seq_cst)) { scheduler.get().wake_helpers(); }
+
+    // alert callbacks by registering them as callbacks on the underlying cell, this happens outside of the lock
+    // as an already written cell may resume them inline
+    for (auto& continuation : continuations) {
+        new_cell->await(std::move(continuation.callback), continuation.dispatch);
+    }
+
     return true;
 }
 
 
+template <typename T, typename Err>
+auto Cell::TrackingOnceCell<T, Err>::is_tracked() const -> bool {
+    const std::shared_lock lock(mutex);
+    return cell.has_value();
+}
+
+
+// as with WriteOnceCell::block has_helpers is published before the helper first checks the cell, so either the helper
+// observes the track or track observes has_helpers and wakes the helper. The tracked cell is blocked on outside of the
+// lock, it wakes (and helps) its own blockers once it is written
 template <typename T, typename Err>
 auto Cell::TrackingOnceCell<T, Err>::block() const -> Cell::Result<T, Err> {
-    std::shared_lock lock(mutex);
-
-    if (!this->cell.has_value()) { cell_filled.wait(lock); }
-    // NOLINTBEGIN(bugprone-unchecked-optional-access)
-    // Note: it's safe to perform an unchecked optional access here as the semantics of the 
-    //       cell_filled.wait function guarantees that the cell will be filled by the time we reach this point
-    //       hence the optional will never be nullopt
-    return this->cell.value()->block();
-    // NOLINTEND(bugprone-unchecked-optional-access)
+    if (!is_tracked()) {
+        has_helpers.store(true, std::memory_order_seq_cst);
+        static_cast<void>(scheduler.get().help_until([this]() { return is_tracked(); }));
+    }
+
+    auto tracked = std::shared_ptr<ICell<T, Err>>();
+    {
+        std::shared_lock lock(mutex);
+        cell_filled.wait(lock, [this]() { return cell.has_value(); });
+        // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+        tracked = cell.value();
+    }
+
+    return tracked->block();
 }
\ No newline at end of file
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <functional>
 #include <atomic>
@@ -11,46 +14,64 @@
 
 namespace Cell {
     // WhenAllCell, like WhenAnyCell assumes ownership of the cells it is tracking
-    // and resolves when all of the cells it is tracking resolves
-    template <typename T, typename Err>
-    class WhenAllCell : public ICell<std::vector<T>, Err> {
+    // and resolves when all of the cells it is tracking resolves. Each resolved value is moved into its slot and the
+    // slots are moved into the final vector, the only copy of a value is the one its cell hands to the continuation.
+    // Values is either std::vector<T> or std::shared_ptr<const std::vector<T>>, in the latter case the awaiters of
+    // this cell share the vector rather than each receiving a copy of it
+    template <typename T, typename Err, typename Values = std::vector<T>>
+    class WhenAllCell : public ICell<Values, Err> {
+        static_assert(std::is_same_v<Values, std::vector<T>> || std::is_same_v<Values, std::shared_ptr<const std::vector<T>>>,
+                      "WhenAllCell resolves to either a vector or a shared vector");
+
     public:
         WhenAllCell(Scheduler::IScheduler& scheduler, std::vector<std::shared_ptr<ICell<T, Err>>> cells);
 
-        [[nodiscard]] auto read() const -> std::optional<Cell::Result<std::vector<T>, Err>> override;
-        [[nodiscard]] auto block() const -> Cell::Result<std::vector<T>, Err> override;
-        auto await(Callback<std::vector<T>, Err> callback) -> void override;
+        [[nodiscard]] auto read() const -> std::optional<Cell::Result<Values, Err>> override;
+        [[nodiscard]] auto block() const -> Cell::Result<Values, Err> override;
+        auto await(Callback<Values, Err> callback, Dispatch dispatch) -> void override;
 
     private:
         struct WhenAllExecutionContext {
         public:
-            explicit WhenAllExecutionContext(std::vector<T> resolved_values) :
-                _resolved_values(resolved_values),
+            explicit WhenAllExecutionContext(size_t total_cells) :
+                slots(total_cells),
                 num_resolved_cells(0),
-                total_cells(resolved_values.size())
+                total_cells(total_cells)
             {}
 
-            // commit_resolved_value is a helper function that commits a resolved value to the execution context
+            // commit_resolved_value is a helper function that moves a resolved value into its slot of the execution context
             // and increments the number of resolved cells. The boolean returned indicates if committing this value
             // resulted in ALL cells having finally been resolved
-            // Safety: we don't actually need mutual exclusion here, the cells array is already resized and we are
-            // guaranteed that each cell touches a unique part of the cells array
+            // Safety: we don't actually need mutual exclusion here, the slots are already sized and we are
+            // guaranteed that each cell touches a unique slot, the acq_rel increment publishes every slot to the
+            // continuation that commits the last value
             [[nodiscard]] auto commit_resolved_value(size_t cell_id, T value) -> bool {
-                _resolved_values[cell_id] = value;
-                auto cells_resolved_so_far = num_resolved_cells.fetch_add(1, std::memory_order_relaxed);
+                slots[cell_id].emplace(std::move(value));
+                auto cells_resolved_so_far = num_resolved_cells.fetch_add(1, std::memory_order_acq_rel);
                 return cells_resolved_so_far + 1 >= total_cells;
             }
 
-            [[nodiscard]] auto resolved_values() -> std::vector<T>& { return _resolved_values; }
+            // take_resolved_values moves the values out of their slots, it may only be called once every cell has resolved
+            [[nodiscard]] auto take_resolved_values() -> Values {
+                auto values = std::vector<T>();
+                values.reserve(slots.size());
+                for (auto& slot : slots) { values.push_back(std::move(*slot)); } // NOLINT(bugprone-unchecked-optional-access)
+
+                if constexpr (std::is_same_v<Values, std::vector<T>>) {
+                    return values;
+                } else {
+                    return std::make_shared<const std::vector<T>>(std::move(values));
+                }
+            }
 
         private:
-            std::vector<T> _resolved_values;
+            std::vector<std::optional<T>> slots;
             std::atomic<size_t> num_resolved_cells;
             size_t total_cells;
         };
 
 
-        std::shared_ptr<WriteOnceCell<std::vector<T>, Err>> underlying_cell;
+        std::shared_ptr<WriteOnceCell<Values, Err>> underlying_cell;
         std::vector<std::shared_ptr<ICell<T, Err>>> cells;
     };
 }
@@ -59,9 +80,9 @@ namespace Cell {
 
 
 // Implementation
-template <typename T, typename Err>
-Cell::WhenAllCell<T, Err>::WhenAllCell(Scheduler::IScheduler& scheduler, std::vector<std::shared_ptr<ICell<T, Err>>> cells) : 
-    underlying_cell(std::make_shared<WriteOnceCell<std::vector<T>, Err>>(scheduler)),
+template <typename T, typename Err, typename Values>
+Cell::WhenAllCell<T, Err, Values>::WhenAllCell(Scheduler::IScheduler& scheduler, std::vector<std::shared_ptr<ICell<T, Err>>> cells) : 
+    underlying_cell(make_cell<WriteOnceCell<Values, Err>>(scheduler)),
     cells(std::move(cells))
 {
     // We maintain a shared execution context for the same reason why underlying_cell is itself a shared pointer
@@ -69,32 +90,32 @@ Cell::WhenAllCell<T, Err>::WhenAllCell(Scheduler::IScheduler& scheduler, std::ve
     // for each of the cells, while such a situation is sad we need to ensure no erroneous situations arise, ie. no segfaults,
     // hence even though the continuations will never be used (the parent died) they must capture a reference to the underlying
     // cell and all associated metadata
-    auto execution_context = std::make_shared<WhenAllExecutionContext>(std::vector<T>(this->cells.size()));
+    auto execution_context = std::allocate_shared<WhenAllExecutionContext>(SlabAllocator<WhenAllExecutionContext>(), this->cells.size());
     auto underlying_cell = this->underlying_cell;
 
     for (auto cell_id = size_t(0); cell_id < this->cells.size(); cell_id += 1) {
-        this->cells[cell_id]->await([execution_context, cell_id, underlying_cell](auto ctx, auto value) {
-            Cell::visit_result(value, 
+        this->cells[cell_id]->await([execution_context, cell_id, underlying_cell](auto ctx, Cell::Result<T, Err> value) {
+            Cell::visit_result(std::move(value), 
                 [execution_context, cell_id, underlying_cell, ctx](T value) {
-                    auto all_cells_resolved = execution_context->commit_resolved_value(cell_id, value);
+                    auto all_cells_resolved = execution_context->commit_resolved_value(cell_id, std::move(value));
                     if (all_cells_resolved) {
-                        underlying_cell->write(ctx, execution_context->resolved_values());
+                        underlying_cell->write(ctx, execution_context->take_resolved_values());
                     }
                 },
                 [execution_context, underlying_cell, ctx](Err err) { underlying_cell->error(ctx, err);}
             );            
-        });
+        }, Dispatch::Inline);
     }
 }
 
 
-template <typename T, typename Err>
-auto Cell::WhenAllCell<T, Err>::read() const -> std::optional<Cell::Result<std::vector<T>, Err>> { return underlying_cell->read(); }
+template <typename T, typename Err, typename Values>
+auto Cell::WhenAllCell<T, Err, Values>::read() const -> std::optional<Cell::Result<Values, Err>> { return underlying_cell->read(); }
 
-template <typename T, typename Err>
-auto Cell::WhenAllCell<T, Err>::await(Callback<std::vector<T>, Err> callback) -> void {
-    underlying_cell->await(callback);
+template <typename T, typename Err, typename Values>
+auto Cell::WhenAllCell<T, Err, Values>::await(Callback<Values, Err> callback, Dispatch dispatch) -> void {
+    underlying_cell->await(std::move(callback), dispatch);
 }
 
-template <typename T, typename Err>
-auto Cell::WhenAllCell<T, Err>::block() const -> Cell::Result<std::vector<T>, Err> { return underlying_cell->block(); }
+template <typename T, typename Err, typename Values>
+auto Cell::WhenAllCell<T, Err, Values>::block() const -> Cell::Result<Values, Err> { return underlying_cell->block(); }
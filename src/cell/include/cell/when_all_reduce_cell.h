@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+#include "cell.h"
+#include "write_once_cell.h"
+#include "concurrency/cache_line.h"
+#include "scheduler/scheduler_intf.h"
+
+namespace Cell {
+    // WhenAllReduceCell resolves once all of the cells it is tracking have resolved (or to the first error), it folds each
+    // value into an accumulator as it arrives rather than gathering the values, hence its memory does not grow with the
+    // number of cells. Unlike WhenAllCell it does not hold on to the cells it tracks, a cell is released as soon as its
+    // producer and its other awaiters are done with it.
+    // combine(Acc, T) -> Acc folds a value and combine(Acc, Acc) -> Acc merges two accumulators, values arrive in any
+    // order and so combine must be associative and commutative. Every accumulator starts out as a copy of identity.
+    // The cells are taken as a range (of shared_ptrs to the cells) so that a fan-in need not gather them into a vector first
+    template <typename T, typename Err, typename Acc, typename Combine>
+        requires std::invocable<Combine&, Acc, T> && std::invocable<Combine&, Acc, Acc>
+    class WhenAllReduceCell : public ICell<Acc, Err> {
+    public:
+        template <std::ranges::sized_range Cells>
+        WhenAllReduceCell(Scheduler::IScheduler& scheduler, Cells&& cells, Acc identity, Combine combine);
+
+        [[nodiscard]] auto read() const -> std::optional<Cell::Result<Acc, Err>> override;
+        [[nodiscard]] auto block() const -> Cell::Result<Acc, Err> override;
+        auto await(Callback<Acc, Err> callback, Dispatch dispatch) -> void override;
+
+    private:
+        // Partial is the accumulator of a worker, a partial is claimed with a single exchange of its flag. A thread that
+        // finds a partial claimed moves on to the next one rather than waiting on it, workers fold into the partial of
+        // their own id so only threads outside the workers (ie. an IO poll thread) ever have to move on
+        struct alignas(cache_line_size) Partial {
+            std::atomic<bool> claimed = { false };
+            std::optional<Acc> accumulator;
+        };
+
+        struct WhenAllReduceExecutionContext {
+        public:
+            WhenAllReduceExecutionContext(std::shared_ptr<WriteOnceCell<Acc, Err>> underlying_cell, size_t total_cells, size_t n_partials, Acc identity, Combine combine) :
+                underlying_cell(std::move(underlying_cell)),
+                partials(std::make_unique<Partial[]>(n_partials)), // NOLINT(cppcoreguidelines-avoid-c-arrays)
+                n_partials(n_partials),
+                total_cells(total_cells),
+                identity(std::move(identity)),
+                combine(std::move(combine))
+            {}
+
+            // fold combines value into the partial of the worker running ctx, the fold of the last value merges the
+            // partials and resolves the underlying cell. The acq_rel increment publishes every partial to that fold
+            auto fold(Scheduler::Context ctx, T value) -> void;
+            auto fail(Scheduler::Context ctx, Err err) -> void { underlying_cell->error(ctx, std::move(err)); }
+
+            // merge_partials folds the partials together, it may only be called once every cell has resolved
+            [[nodiscard]] auto merge_partials() -> Acc;
+
+        private:
+            std::shared_ptr<WriteOnceCell<Acc, Err>> underlying_cell;
+            std::unique_ptr<Partial[]> partials; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+            size_t n_partials;
+            std::atomic<size_t> num_resolved_cells = { 0 };
+            size_t total_cells;
+            const Acc identity;
+            Combine combine;
+        };
+
+        std::shared_ptr<WriteOnceCell<Acc, Err>> underlying_cell;
+    };
+}
+
+
+
+
+// Implementation
+template <typename T, typename Err, typename Acc, typename Combine>
+    requires std::invocable<Combine&, Acc, T> && std::invocable<Combine&, Acc, Acc>
+template <std::ranges::sized_range Cells>
+Cell::WhenAllReduceCell<T, Err, Acc, Combine>::WhenAllReduceCell(Scheduler::IScheduler& scheduler, Cells&& cells, Acc identity, Combine combine) :
+    underlying_cell(make_cell<WriteOnceCell<Acc, Err>>(scheduler))
+{
+    if (std::ranges::empty(cells)) {
+        underlying_cell->write(std::move(identity));
+        return;
+    }
+
+    // a partial per worker and one more shared by the threads outside of the workers, the continuations own the execution
+    // context (and through it the underlying cell) as this cell may well be destroyed before the cells it tracks resolve
+    auto n_partials = static_cast<size_t>(scheduler.concurrency()) + 1;
+    auto execution_context = std::allocate_shared<WhenAllReduceExecutionContext>(SlabAllocator<WhenAllReduceExecutionContext>(),
+        underlying_cell, static_cast<size_t>(std::ranges::size(cells)), n_partials, std::move(identity), std::move(combine));
+
+    for (const std::shared_ptr<ICell<T, Err>>& cell : cells) {
+        cell->await([execution_context](auto ctx, Cell::Result<T, Err> value) {
+            Cell::visit_result(std::move(value),
+                [&execution_context, ctx](T value) { execution_context->fold(ctx, std::move(value)); },
+                [&execution_context, ctx](Err err) { execution_context->fail(ctx, std::move(err)); });
+        }, Dispatch::Inline);
+    }
+}
+
+template <typename T, typename Err, typename Acc, typename Combine>
+    requires std::invocable<Combine&, Acc, T> && std::invocable<Combine&, Acc, Acc>
+auto Cell::WhenAllReduceCell<T, Err, Acc, Combine>::WhenAllReduceExecutionContext::fold(Scheduler::Context ctx, T value) -> void {
+    // workers ids beyond the initial number of workers (of an elastic pool) wrap around onto the other partials
+    auto index = static_cast<size_t>(ctx.worker().value_or(static_cast<unsigned int>(n_partials - 1))) % n_partials;
+    while (partials[index].claimed.exchange(true, std::memory_order_acquire)) {
+        index = (index + 1) % n_partials;
+    }
+
+    auto& partial = partials[index];
+    if (!partial.accumulator.has_value()) { partial.accumulator.emplace(identity); }
+    *partial.accumulator = combine(std::move(*partial.accumulator), std::move(value)); // NOLINT(bugprone-unchecked-optional-access)
+    partial.claimed.store(false, std::memory_order_release);
+
+    auto cells_resolved_so_far = num_resolved_cells.fetch_add(1, std::memory_order_acq_rel);
+    if (cells_resolved_so_far + 1 == total_cells) {
+        underlying_cell->write(ctx, merge_partials());
+    }
+}
+
+template <typename T, typename Err, typename Acc, typename Combine>
+    requires std::invocable<Combine&, Acc, T> && std::invocable<Combine&, Acc, Acc>
+auto Cell::WhenAllReduceCell<T, Err, Acc, Combine>::WhenAllReduceExecutionContext::merge_partials() -> Acc {
+    auto merged = std::optional<Acc>();
+    for (size_t i = 0; i < n_partials; i++) {
+        auto& partial = partials[i].accumulator;
+        if (!partial.has_value()) { continue; }
+
+        if (merged.has_value()) {
+            *merged = combine(std::move(*merged), std::move(*partial));
+        } else {
+            merged.emplace(std::move(*partial));
+        }
+
+        partial.reset();
+    }
+
+    return std::move(*merged); // NOLINT(bugprone-unchecked-optional-access)
+}
+
+
+template <typename T, typename Err, typename Acc, typename Combine>
+    requires std::invocable<Combine&, Acc, T> && std::invocable<Combine&, Acc, Acc>
+auto Cell::WhenAllReduceCell<T, Err, Acc, Combine>::read() const -> std::optional<Cell::Result<Acc, Err>> { return underlying_cell->read(); }
+
+template <typename T, typename Err, typename Acc, typename Combine>
+    requires std::invocable<Combine&, Acc, T> && std::invocable<Combine&, Acc, Acc>
+auto Cell::WhenAllReduceCell<T, Err, Acc, Combine>::await(Callback<Acc, Err> callback, Dispatch dispatch) -> void {
+    underlying_cell->await(std::move(callback), dispatch);
+}
+
+template <typename T, typename Err, typename Acc, typename Combine>
+    requires std::invocable<Combine&, Acc, T> && std::invocable<Combine&, Acc, Acc>
+auto Cell::WhenAllReduceCell<T, Err, Acc, Combine>::block() const -> Cell::Result<Acc, Err> { return underlying_cell->block(); }
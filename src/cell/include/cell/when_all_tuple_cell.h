@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#include "cell.h"
+#include "write_once_cell.h"
+#include "scheduler/scheduler_intf.h"
+
+namespace Cell {
+    template <typename Tuple, typename Err>
+    class WhenAllTupleCell;
+
+    // WhenAllTupleCell is the heterogeneous counterpart of WhenAllCell, it tracks a fixed set of cells of (possibly)
+    // differing types and resolves to a tuple of their values once all of them have resolved, or to the first error.
+    // The cells are awaited over a compile time index sequence, each resolved value is moved into its own slot and the
+    // slots are moved into the final tuple, hence the only copy of a value is the one its cell hands to the continuation
+    template <typename... Ts, typename Err>
+    class WhenAllTupleCell<std::tuple<Ts...>, Err> : public ICell<std::tuple<Ts...>, Err> {
+    public:
+        explicit WhenAllTupleCell(Scheduler::IScheduler& scheduler, std::shared_ptr<ICell<Ts, Err>>... cells);
+
+        [[nodiscard]] auto read() const -> std::optional<Cell::Result<std::tuple<Ts...>, Err>> override;
+        [[nodiscard]] auto block() const -> Cell::Result<std::tuple<Ts...>, Err> override;
+        auto await(Callback<std::tuple<Ts...>, Err> callback, Dispatch dispatch) -> void override;
+
+    private:
+        // WhenAllExecutionContext holds a slot per cell, each cell writes to its own slot hence the slots need no
+        // mutual exclusion, the acq_rel increment publishes every slot to the continuation that resolves the last cell
+        struct WhenAllExecutionContext {
+            std::tuple<std::optional<Ts>...> slots;
+            std::atomic<size_t> num_resolved_cells = { 0 };
+
+            // take_resolved_values moves the values out of their slots, it may only be called once every cell has resolved
+            [[nodiscard]] auto take_resolved_values() -> std::tuple<Ts...> {
+                return std::apply([](auto&... slot) { return std::tuple<Ts...>(std::move(*slot)...); }, slots); // NOLINT(bugprone-unchecked-optional-access)
+            }
+        };
+
+        template <size_t Index>
+        static auto await_cell(const std::shared_ptr<ICell<std::tuple_element_t<Index, std::tuple<Ts...>>, Err>>& cell,
+                               const std::shared_ptr<WhenAllExecutionContext>& execution_context,
+                               const std::shared_ptr<WriteOnceCell<std::tuple<Ts...>, Err>>& underlying_cell) -> void;
+
+        std::shared_ptr<WriteOnceCell<std::tuple<Ts...>, Err>> underlying_cell;
+        std::tuple<std::shared_ptr<ICell<Ts, Err>>...> cells;
+    };
+}
+
+
+
+
+// Implementation
+template <typename... Ts, typename Err>
+Cell::WhenAllTupleCell<std::tuple<Ts...>, Err>::WhenAllTupleCell(Scheduler::IScheduler& scheduler, std::shared_ptr<ICell<Ts, Err>>... cells) :
+    underlying_cell(make_cell<WriteOnceCell<std::tuple<Ts...>, Err>>(scheduler)),
+    cells(std::move(cells)...)
+{
+    // as with WhenAllCell the continuations own the execution context and the underlying cell, as this cell may well
+    // be destroyed before the cells it tracks resolve
+    auto execution_context = std::allocate_shared<WhenAllExecutionContext>(SlabAllocator<WhenAllExecutionContext>());
+    [&]<size_t... Indices>(std::index_sequence<Indices...>) {
+        (await_cell<Indices>(std::get<Indices>(this->cells), execution_context, underlying_cell), ...);
+    }(std::index_sequence_for<Ts...>());
+}
+
+template <typename... Ts, typename Err>
+template <size_t Index>
+auto Cell::WhenAllTupleCell<std::tuple<Ts...>, Err>::await_cell(const std::shared_ptr<ICell<std::tuple_element_t<Index, std::tuple<Ts...>>, Err>>& cell,
+                                                               const std::shared_ptr<WhenAllExecutionContext>& execution_context,
+                                                               const std::shared_ptr<WriteOnceCell<std::tuple<Ts...>, Err>>& underlying_cell) -> void {
+    using T = std::tuple_element_t<Index, std::tuple<Ts...>>;
+
+    cell->await([execution_context, underlying_cell](auto ctx, Cell::Result<T, Err> value) {
+        Cell::visit_result(std::move(value),
+            [&execution_context, &underlying_cell, ctx](T value) {
+                std::get<Index>(execution_context->slots).emplace(std::move(value));
+                auto cells_resolved_so_far = execution_context->num_resolved_cells.fetch_add(1, std::memory_order_acq_rel);
+                if (cells_resolved_so_far + 1 == sizeof...(Ts)) {
+                    underlying_cell->write(ctx, execution_context->take_resolved_values());
+                }
+            },
+            [&underlying_cell, ctx](Err err) { underlying_cell->error(ctx, err); }
+        );
+    }, Dispatch::Inline);
+}
+
+
+template <typename... Ts, typename Err>
+auto Cell::WhenAllTupleCell<std::tuple<Ts...>, Err>::read() const -> std::optional<Cell::Result<std::tuple<Ts...>, Err>> { return underlying_cell->read(); }
+
+template <typename... Ts, typename Err>
+auto Cell::WhenAllTupleCell<std::tuple<Ts...>, Err>::await(Callback<std::tuple<Ts...>, Err> callback, Dispatch dispatch) -> void {
+    underlying_cell->await(std::move(callback), dispatch);
+}
+
+template <typename... Ts, typename Err>
+auto Cell::WhenAllTupleCell<std::tuple<Ts...>, Err>::block() const -> Cell::Result<std::tuple<Ts...>, Err> { return underlying_cell->block(); }
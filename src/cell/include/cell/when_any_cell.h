@@ -4,6 +4,7 @@
 #include <vector>
 #include <atomic>
 #include <functional>
+#include <utility>
 
 #include "cell.h"
 #include "write_once_cell.h"
@@ -19,7 +20,7 @@ namespace Cell {
 
         [[nodiscard]] auto read() const -> std::optional<Cell::Result<T, Err>> override;
         [[nodiscard]] auto block() const -> Cell::Result<T, Err> override;
-        auto await(Callback<T, Err> callback) -> void override;
+        auto await(Callback<T, Err> callback, Dispatch dispatch) -> void override;
     
     private:
         class WhenAnyExecutionContext {
@@ -48,20 +49,20 @@ namespace Cell {
 // Implementation
 template <typename T, typename Err>
 Cell::WhenAnyCell<T, Err>::WhenAnyCell(Scheduler::IScheduler& scheduler, std::vector<std::shared_ptr<ICell<T, Err>>> cells) : 
-    underlying_cell(std::make_shared<WriteOnceCell<T, Err>>(scheduler)),
+    underlying_cell(make_cell<WriteOnceCell<T, Err>>(scheduler)),
     cells(std::move(cells))
 {
     // Underlying cell must be a shared pointer because there is a chance that the destructor of the WhenAnyCell
     // gets invoked prior to the runtime scheduling the continuation we pass to the cells... if this happens it would be sad
     // however to prevent erroneous situations we only invoke the destructor of the underlying cell once all the cells have resolved
     // ie. each of the callbacks must assume ownership of the underlying cell
-    auto exe_ctx = std::make_shared<WhenAnyExecutionContext>(this->cells.size());
+    auto exe_ctx = std::allocate_shared<WhenAnyExecutionContext>(SlabAllocator<WhenAnyExecutionContext>(), this->cells.size());
     auto underlying_cell = this->underlying_cell;
 
     for (auto& cell: this->cells) {
         cell->await([underlying_cell, exe_ctx](auto ctx, Cell::Result<T, Err> value) {
-            Cell::visit_result(value, 
-                [underlying_cell, ctx](T value) { underlying_cell->write(ctx, value); }, 
+            Cell::visit_result(std::move(value), 
+                [underlying_cell, ctx](T value) { underlying_cell->write(ctx, std::move(value)); }, 
                 [underlying_cell, ctx, exe_ctx] (Err err) {
                     auto all_cells_have_errored = exe_ctx->log_error();
                     if (all_cells_have_errored) {
@@ -69,7 +70,7 @@ Cell::WhenAnyCell<T, Err>::WhenAnyCell(Scheduler::IScheduler& scheduler, std::ve
                     }
                 }
             );
-        });
+        }, Dispatch::Inline);
     }
 }
 
@@ -78,7 +79,7 @@ template <typename T, typename Err>
 auto Cell::WhenAnyCell<T, Err>::read() const -> std::optional<Cell::Result<T, Err>> { return underlying_cell->read(); }
 
 template <typename T, typename Err>
-auto Cell::WhenAnyCell<T, Err>::await(Callback<T, Err> callback) -> void { underlying_cell->await(callback); }
+auto Cell::WhenAnyCell<T, Err>::await(Callback<T, Err> callback, Dispatch dispatch) -> void { underlying_cell->await(std::move(callback), dispatch); }
 
 template <typename T, typename Err>
 auto Cell::WhenAnyCell<T, Err>::block() const -> Cell::Result<T, Err> { return underlying_cell->block(); }
\ No newline at end of file
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <optional>
 #include <functional>
+#include <utility>
 #include <vector>
 #include <shared_mutex>
 #include <condition_variable>
 
 #include "cell.h"
 #include "scheduler/scheduler_intf.h"
+#include "scheduler/tracer.h"
 
 namespace Cell {
     /// WriteOnceCell is a class that represents a cell that can be written to once
@@ -31,28 +35,43 @@ namespace Cell {
             return write_result_to_value(ctx, Cell::Result<T, Err>(err));
         }
 
-        auto write(T write_val) -> bool { return write(Scheduler::Context::empty(), write_val); }
+        auto write(T write_val) -> bool { return write(Scheduler::Context::empty(), std::move(write_val)); }
         auto write(Scheduler::Context ctx, T write_val) -> bool {
-            return write_result_to_value(ctx, Cell::Result<T, Err>(write_val));
+            return write_result_to_value(ctx, Cell::Result<T, Err>(std::move(write_val)));
         }
 
         // await takes a callback function and calls it with the value
-        // of the WriteOnceCell when it is available.
-        auto await(Callback<T, Err> callback) -> void override;
+        // of the WriteOnceCell when it is available. If the cell has already been written the callback is dispatched
+        // straight away, from a worker it then runs on (or is queued onto) that worker rather than the global queue
+        auto await(Callback<T, Err> callback, Dispatch dispatch) -> void override;
             
         // block sleeps the current thread until the value of the cell is available
         // it then returns the value of the cell, note that this is different from await
-        // as await registers a continuation, while block is a blocking operation
+        // as await registers a continuation, while block is a blocking operation.
+        // If block is invoked from one of the scheduler's workers the worker runs other jobs until the cell is written
+        // rather than sleeping (see IScheduler::help_until), this prevents a job that blocks on work queued behind it
+        // from deadlocking a small pool
         [[nodiscard]] auto block() const -> Cell::Result<T, Err> override;
 
     private:
         auto write_result_to_value(Scheduler::Context ctx, Cell::Result<T, Err> result) -> bool;
 
+        // is_written checks for a value without copying it out of the cell (unlike read)
+        [[nodiscard]] auto is_written() const -> bool;
+
+        // resume dispatches the continuations of the cell once it has been written, the queued continuations are queued
+        // first and then the last inline continuation runs on the calling worker, so it never delays its siblings.
+        // Each continuation is handed a copy of the result by move, the cell's own value is left as is. Note the copy
+        // is init-captured, a plain capture of the const reference would be const and so be copied on every move
+        auto resume(Scheduler::Context ctx, Callbacks<T, Err>& continuations, const Cell::Result<T, Err>& result) -> void;
+
         mutable std::shared_mutex mutex;
         mutable std::optional<Cell::Result<T, Err>> value;
             
-        std::vector<Callback<T, Err>> callbacks;
+        Callbacks<T, Err> callbacks;
         mutable std::condition_variable_any cell_filled;
+        // has_helpers is set once a worker has blocked on the cell, the writer must then wake the scheduler's helpers
+        mutable std::atomic<bool> has_helpers = { false };
 
         //  Note: it is an invariant of the Asynchronous library that the scheduler's
         //        is of 'static lifetime and hence will outlive any cell that uses it
@@ -77,55 +96,85 @@ auto Cell::WriteOnceCell<T, Err>::read() const -> std::optional<Cell::Result<T,
     return this->value;
 }
 
+template <typename T, typename Err>
+auto Cell::WriteOnceCell<T, Err>::is_written() const -> bool {
+    const std::shared_lock lock(mutex);
+    return value.has_value();
+}
+
 template <typename T, typename Err>
 auto Cell::WriteOnceCell<T, Err>::write_result_to_value(Scheduler::Context ctx, Cell::Result<T, Err> result) -> bool {
+    Scheduler::Tracer::trace(Scheduler::TraceEvent::CellWrite, reinterpret_cast<uintptr_t>(this)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+    // the continuations are taken out of the cell and resumed once the lock is released as inline continuations may
+    // well read this cell, this also releases any reference we may indirectly maintain through them
+    auto continuations = Callbacks<T, Err>();
     {
         const std::unique_lock lock(mutex);
         if (value.has_value()) { return false; }
-        value = std::optional(result);
-
-        // alert callbacks by scheduling continuations
-        // on the scheduler
-        for (auto& callback : callbacks) {
-            scheduler.get().queue(ctx, [=] (auto ctx) { callback(ctx, result); });
-        }
-
-        // clear the callbacks to release any reference we may indirectly maintain
-        callbacks.clear();
+        value.emplace(std::move(result));
+        continuations.swap(callbacks);
     }
 
-    // awake any blocking threads prior to returning
+    // awake any blocking threads prior to resuming the continuations
     cell_filled.notify_all();
+    if (has_helpers.load(std::memory_order_seq_cst)) { scheduler.get().wake_helpers(); }
+
+    // the value is never written again once it has been set, hence it can be read without holding the lock
+    resume(ctx, continuations, *value); // NOLINT(bugprone-unchecked-optional-access)
     return true;
 }
 
 template <typename T, typename Err>
-auto Cell::WriteOnceCell<T, Err>::await(Callback<T, Err> callback) -> void {
-    // note that we take a shared lock here to prevent lock contention, as 
-    // write_result_to_value is the only other fn that would use the callbacks vector (and claims a unique lock)
-    // it is impossible for both await and write to be in the critical section at the same time
-    const std::shared_lock lock(mutex);
-    if (value.has_value()) {
-        auto value_inner = value.value();
-        scheduler.get().queue(
-            Scheduler::Context::empty(),
-            [callback, value_inner] (auto ctx) { callback(ctx, value_inner); });
+auto Cell::WriteOnceCell<T, Err>::resume(Scheduler::Context ctx, Callbacks<T, Err>& continuations, const Cell::Result<T, Err>& result) -> void {
+    auto inline_index = continuations.size();
+    for (size_t i = 0; i < continuations.size(); i++) {
+        if (continuations[i].dispatch == Dispatch::Inline) { inline_index = i; }
+    }
 
-        return;
+    for (size_t i = 0; i < continuations.size(); i++) {
+        if (i == inline_index) { continue; }
+        scheduler.get().queue(ctx, [callback = std::move(continuations[i].callback), result = Cell::Result<T, Err>(result)] (auto ctx) mutable { callback(ctx, std::move(result)); });
     }
 
-    callbacks.push_back(callback);
+    if (inline_index < continuations.size()) {
+        auto job = Scheduler::Job([callback = std::move(continuations[inline_index].callback), result = Cell::Result<T, Err>(result)] (auto ctx) mutable { callback(ctx, std::move(result)); });
+        if (!scheduler.get().run_inline(ctx, job)) { scheduler.get().queue(ctx, std::move(job)); }
+    }
 }
 
 template <typename T, typename Err>
-auto Cell::WriteOnceCell<T, Err>::block() const -> Cell::Result<T, Err> {
+auto Cell::WriteOnceCell<T, Err>::await(Callback<T, Err> callback, Dispatch dispatch) -> void {
+    // concurrent awaits all push onto the callbacks vector, hence a pending cell is awaited under a unique lock
+    Scheduler::Tracer::trace(Scheduler::TraceEvent::CellAwait, reinterpret_cast<uintptr_t>(this)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto continuations = Callbacks<T, Err>();
     {
-        std::shared_lock lock(mutex);
+        const std::unique_lock lock(mutex);
         if (!value.has_value()) {
-            cell_filled.wait(lock);
+            callbacks.push_back({ std::move(callback), dispatch });
+            return;
         }
     }
 
+    // the cell has been written and so its value is immutable, resume copies it for the continuation
+    continuations.push_back({ std::move(callback), dispatch });
+    resume(Scheduler::Context::empty(), continuations, *value); // NOLINT(bugprone-unchecked-optional-access)
+}
+
+template <typename T, typename Err>
+auto Cell::WriteOnceCell<T, Err>::block() const -> Cell::Result<T, Err> {
+    // has_helpers is published before the helper first checks the cell, so either the helper observes the write
+    // or the writer observes has_helpers and wakes the helper
+    if (!is_written()) {
+        has_helpers.store(true, std::memory_order_seq_cst);
+        static_cast<void>(scheduler.get().help_until([this]() { return is_written(); }));
+    }
+
+    {
+        std::shared_lock lock(mutex);
+        cell_filled.wait(lock, [this]() { return value.has_value(); });
+    }
+
     // NOLINTBEGIN(bugprone-unchecked-optional-access)
     // Note: it's safe to perform an unchecked optional access here as the semantics of the 
     //       cell_filled.wait function guarantees that the cell will be filled by the time we reach this point
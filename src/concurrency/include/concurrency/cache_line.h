@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// cache_line_size is the alignment that keeps two objects from sharing a cache line (and hence from false sharing),
+// it is std::hardware_destructive_interference_size where the standard library provides it and 64 bytes otherwise
+#ifdef __cpp_lib_hardware_interference_size
+// GCC warns that the value may differ between translation units tuned for different CPUs, every object aligned by it
+// lives in this library so a single value per build is all that is needed
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif
+inline constexpr size_t cache_line_size = std::hardware_destructive_interference_size;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#else
+inline constexpr size_t cache_line_size = 64;
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "concurrency/cache_line.h"
+
+// EventCount is a condition variable for lock-free data structures, it allows a thread to sleep until some condition
+// (ie. "a queue is non-empty") holds without requiring the producers of that condition to take a lock. Waiting
+// is a two phase process:
+//      auto key = event_count.prepare_wait();
+//      if (condition_holds()) { event_count.cancel_wait(); }
+//      else { event_count.wait(key); }
+//
+// A producer makes the condition true and then calls notify, any waiter that prepared prior to the notification is
+// guaranteed to either observe the condition or be woken. Waiters sleep on a futex over the epoch, hence producers
+// only perform a syscall when there are registered waiters.
+class EventCount {
+public:
+    using Key = uint32_t;
+
+    [[nodiscard]] auto prepare_wait() -> Key;
+    auto cancel_wait() -> void;
+    auto wait(Key key) -> void;
+
+    // wait_for is wait with a timeout, it returns false if the timeout elapsed without a notification. A waiter that
+    // times out may still be counted by a concurrent notify, the caller must re-check its condition after timing out
+    [[nodiscard]] auto wait_for(Key key, std::chrono::nanoseconds timeout) -> bool;
+
+    // notify wakes up to n waiters, notify_all wakes every waiter
+    auto notify(uint32_t n) -> void;
+    auto notify_all() -> void;
+
+    // Note: waiters has a relaxed memory order and hence is only approximate
+    [[nodiscard]] auto waiters() const -> uint32_t;
+
+private:
+    alignas(cache_line_size) std::atomic<uint32_t> epoch = { 0 };
+    alignas(cache_line_size) std::atomic<uint32_t> num_waiters = { 0 };
+};
@@ -0,0 +1,360 @@
+#pragma once
+
+#include <atomic>
+#include <array>
+#include <memory>
+#include <optional>
+#include <new>
+#include <thread>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+#include "concurrency/cache_line.h"
+
+// SegmentedQueue is an unbounded lock-free multi-producer multi-consumer FIFO queue, it is a port of the segmented
+// queue used by crossbeam (crossbeam_queue::SegQueue). The queue is a linked list of fixed size blocks, each block
+// holding block_capacity slots.
+//  - Producers claim a slot by advancing the tail index with a CAS and then write into that slot
+//  - Consumers claim slots by advancing the head index with a CAS and then wait for the claimed slot to be written
+//  - The queue never resizes, when the tail block fills up the producer that claimed the last slot of the block
+//    installs the next block, the block is then freed by the last consumer to finish reading from it
+//
+// Indices are "positions" shifted left by one, the lowest bit of the head index records whether the head block
+// is known to have a successor (in which case consumers don't need to inspect the tail). Every lap of lap positions
+// maps onto a single block, the final position within a lap does not correspond to a slot and instead marks that
+// the next block is currently being installed.
+template <typename T>
+class SegmentedQueue {
+public:
+    SegmentedQueue() = default;
+    ~SegmentedQueue();
+
+    SegmentedQueue(SegmentedQueue& other) = delete;
+    SegmentedQueue(SegmentedQueue&& other) = delete;
+    auto operator=(SegmentedQueue& other) -> SegmentedQueue& = delete;
+    auto operator=(SegmentedQueue&& other) -> SegmentedQueue& = delete;
+
+    auto enqueue(T&& item) -> void;
+
+    // enqueue_bulk moves count items from items onto the queue (preserving their order), every item placed in the same
+    // block is claimed with a single CAS over the tail of the queue
+    template <typename InputIt>
+    auto enqueue_bulk(InputIt items, size_t count) -> void;
+    [[nodiscard]] auto try_dequeue() -> std::optional<T>;
+
+    // try_dequeue_bulk pops up to max_items from the queue (in FIFO order) writing them to output, it returns
+    // the number of items that were dequeued. Items are claimed a block at a time, every item claimed from the same
+    // block is claimed with a single CAS over the head of the queue
+    template <typename OutputIt>
+    auto try_dequeue_bulk(OutputIt output, size_t max_items) -> size_t;
+
+    // Note: size is only approximate in the presence of concurrent producers or consumers
+    [[nodiscard]] auto size() const -> size_t;
+
+private:
+    constexpr static size_t lap = 64;
+    constexpr static size_t block_capacity = lap - 1;
+    constexpr static size_t shift = 1;
+    constexpr static size_t has_next = 1;
+    constexpr static size_t step = size_t(1) << shift;
+
+    // slot states, a slot is written by exactly one producer and read by exactly one consumer, the destroy
+    // bit is set by the thread freeing a block if it encounters a slot whose consumer has not yet finished reading
+    constexpr static size_t slot_written = 1;
+    constexpr static size_t slot_read = 2;
+    constexpr static size_t slot_destroy = 4;
+
+    struct Slot {
+        alignas(T) std::array<std::byte, sizeof(T)> storage;
+        std::atomic<size_t> state = { 0 };
+
+        [[nodiscard]] auto value() -> T* { return std::launder(reinterpret_cast<T*>(storage.data())); }
+        auto wait_until_written() const -> void {
+            auto attempt = 0u;
+            while ((state.load(std::memory_order_acquire) & slot_written) == 0) { backoff(attempt); }
+        }
+    };
+
+    struct Block {
+        std::atomic<Block*> next = { nullptr };
+        std::array<Slot, block_capacity> slots;
+
+        [[nodiscard]] auto wait_for_next() const -> Block* {
+            auto attempt = 0u;
+            for (;;) {
+                if (auto* next_block = next.load(std::memory_order_acquire); next_block != nullptr) { return next_block; }
+                backoff(attempt);
+            }
+        }
+    };
+
+    struct Position {
+        std::atomic<size_t> index = { 0 };
+        std::atomic<Block*> block = { nullptr };
+    };
+
+    // produce claims up to max_items contiguous slots from the tail block and moves items into them, advancing
+    // items past every item written, returns the number of items written
+    template <typename InputIt>
+    auto produce(InputIt& items, size_t max_items) -> size_t;
+
+    // claim claims up to max_items contiguous slots from the head block and hands each item to consume,
+    // returns the number of items claimed (0 if the queue is empty)
+    template <typename Consume>
+    auto claim(size_t max_items, Consume&& consume) -> size_t;
+
+    // destroy_block frees a block once every slot from start onwards has been read, if a slot is still being read
+    // the responsibility of freeing the block is handed off to that slot's consumer
+    static auto destroy_block(Block* block, size_t start) -> void;
+    static auto backoff(unsigned int& attempt) -> void;
+
+    alignas(cache_line_size) Position head;
+    alignas(cache_line_size) Position tail;
+};
+
+
+
+
+
+
+
+// Implementation
+template <typename T>
+SegmentedQueue<T>::~SegmentedQueue() {
+    auto head_index = head.index.load(std::memory_order_relaxed) & ~has_next;
+    auto tail_index = tail.index.load(std::memory_order_relaxed) & ~has_next;
+    auto* block = head.block.load(std::memory_order_relaxed);
+
+    // drop all remaining items, freeing each block as we move past it
+    while (head_index != tail_index) {
+        auto offset = (head_index >> shift) % lap;
+        if (offset < block_capacity) {
+            std::destroy_at(block->slots[offset].value());
+        } else {
+            auto* next_block = block->next.load(std::memory_order_relaxed);
+            auto owned_block = std::unique_ptr<Block>(block);
+            block = next_block;
+        }
+
+        head_index += step;
+    }
+
+    auto owned_block = std::unique_ptr<Block>(block);
+}
+
+template <typename T>
+auto SegmentedQueue<T>::backoff(unsigned int& attempt) -> void {
+    const unsigned int spin_limit = 6;
+    if (attempt <= spin_limit) {
+        for (auto i = 0u; i < (1u << attempt); i++) { __builtin_ia32_pause(); }
+    } else {
+        std::this_thread::yield();
+    }
+
+    attempt += 1;
+}
+
+template <typename T>
+auto SegmentedQueue<T>::destroy_block(Block* block, size_t start) -> void {
+    // the final slot is not marked, the consumer of the final slot is the one that began destroying the block
+    for (auto offset = start; offset + 1 < block_capacity; offset++) {
+        auto& slot = block->slots[offset];
+        if ((slot.state.load(std::memory_order_acquire) & slot_read) == 0 &&
+            (slot.state.fetch_or(slot_destroy, std::memory_order_acq_rel) & slot_read) == 0) {
+            return;
+        }
+    }
+
+    auto owned_block = std::unique_ptr<Block>(block);
+}
+
+template <typename T>
+auto SegmentedQueue<T>::enqueue(T&& item) -> void {
+    auto* items = &item;
+    produce(items, 1);
+}
+
+template <typename T>
+template <typename InputIt>
+auto SegmentedQueue<T>::enqueue_bulk(InputIt items, size_t count) -> void {
+    while (count > 0) { count -= produce(items, count); }
+}
+
+template <typename T>
+template <typename InputIt>
+auto SegmentedQueue<T>::produce(InputIt& items, size_t max_items) -> size_t {
+    auto tail_index = tail.index.load(std::memory_order_acquire);
+    auto* block = tail.block.load(std::memory_order_acquire);
+    auto next_block = std::unique_ptr<Block>();
+    auto attempt = 0u;
+
+    for (;;) {
+        auto offset = (tail_index >> shift) % lap;
+
+        // another producer is installing the next block, wait for it to finish
+        if (offset == block_capacity) {
+            backoff(attempt);
+            tail_index = tail.index.load(std::memory_order_acquire);
+            block = tail.block.load(std::memory_order_acquire);
+            continue;
+        }
+
+        // we will be claiming the last slot of this block, pre-allocate the next block outside of the CAS loop
+        auto count = std::min(max_items, block_capacity - offset);
+        auto end = offset + count;
+        if (end == block_capacity && next_block == nullptr) {
+            next_block = std::make_unique<Block>();
+        }
+
+        // this is the very first item to ever be queued, install the first block
+        if (block == nullptr) {
+            auto first_block = next_block != nullptr ? std::move(next_block) : std::make_unique<Block>();
+            auto* expected = static_cast<Block*>(nullptr);
+            if (tail.block.compare_exchange_strong(expected, first_block.get(), std::memory_order_release, std::memory_order_relaxed)) {
+                block = first_block.release();
+                head.block.store(block, std::memory_order_release);
+            } else {
+                next_block = std::move(first_block);
+                tail_index = tail.index.load(std::memory_order_acquire);
+                block = tail.block.load(std::memory_order_acquire);
+                continue;
+            }
+        }
+
+        auto new_tail = tail_index + (count * step);
+        if (tail.index.compare_exchange_weak(tail_index, new_tail, std::memory_order_seq_cst, std::memory_order_acquire)) {
+            // we claimed the final slot of the block, install the next block and move the tail past the marker position
+            if (end == block_capacity) {
+                auto* installed_block = next_block.release();
+                tail.block.store(installed_block, std::memory_order_release);
+                tail.index.store(new_tail + step, std::memory_order_release);
+                block->next.store(installed_block, std::memory_order_release);
+            }
+
+            for (auto slot_offset = offset; slot_offset < end; slot_offset++, ++items) {
+                auto& slot = block->slots[slot_offset];
+                std::construct_at(slot.value(), std::move(*items));
+                slot.state.fetch_or(slot_written, std::memory_order_release);
+            }
+
+            return count;
+        }
+
+        block = tail.block.load(std::memory_order_acquire);
+        backoff(attempt);
+    }
+}
+
+template <typename T>
+template <typename Consume>
+auto SegmentedQueue<T>::claim(size_t max_items, Consume&& consume) -> size_t {
+    auto head_index = head.index.load(std::memory_order_acquire);
+    auto* block = head.block.load(std::memory_order_acquire);
+    auto attempt = 0u;
+
+    for (;;) {
+        auto offset = (head_index >> shift) % lap;
+
+        // another consumer is moving the head onto the next block, wait for it to finish
+        if (offset == block_capacity) {
+            backoff(attempt);
+            head_index = head.index.load(std::memory_order_acquire);
+            block = head.block.load(std::memory_order_acquire);
+            continue;
+        }
+
+        // determine how many items are available within this block, if the head block is not known to have
+        // a successor we must inspect the tail to determine if the queue is empty
+        auto available = block_capacity - offset;
+        auto new_head_flags = size_t(0);
+        if ((head_index & has_next) == 0) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto tail_index = tail.index.load(std::memory_order_relaxed);
+
+            if ((head_index >> shift) == (tail_index >> shift)) { return 0; }
+            if ((head_index >> shift) / lap != (tail_index >> shift) / lap) {
+                new_head_flags = has_next;
+            } else {
+                available = (tail_index >> shift) - (head_index >> shift);
+            }
+        }
+
+        // the first block has not been installed yet
+        if (block == nullptr) {
+            backoff(attempt);
+            head_index = head.index.load(std::memory_order_acquire);
+            block = head.block.load(std::memory_order_acquire);
+            continue;
+        }
+
+        auto count = std::min(max_items, available);
+        auto new_head = (head_index + (count * step)) | new_head_flags;
+        if (head.index.compare_exchange_weak(head_index, new_head, std::memory_order_seq_cst, std::memory_order_acquire)) {
+            auto end = offset + count;
+
+            // we claimed the final slot of the block, move the head onto the next block
+            if (end == block_capacity) {
+                auto* next_block = block->wait_for_next();
+                auto next_index = (new_head & ~has_next) + step;
+                if (next_block->next.load(std::memory_order_relaxed) != nullptr) { next_index |= has_next; }
+
+                head.block.store(next_block, std::memory_order_release);
+                head.index.store(next_index, std::memory_order_release);
+            }
+
+            for (auto slot_offset = offset; slot_offset < end; slot_offset++) {
+                auto& slot = block->slots[slot_offset];
+                slot.wait_until_written();
+                consume(std::move(*slot.value()));
+                std::destroy_at(slot.value());
+
+                // the consumer of the final slot begins destroying the block, otherwise if the destruction of this
+                // block was previously halted at our slot we must continue it
+                if (slot_offset + 1 == block_capacity) {
+                    destroy_block(block, 0);
+                } else if ((slot.state.fetch_or(slot_read, std::memory_order_acq_rel) & slot_destroy) != 0) {
+                    destroy_block(block, slot_offset + 1);
+                }
+            }
+
+            return count;
+        }
+
+        block = head.block.load(std::memory_order_acquire);
+        backoff(attempt);
+    }
+}
+
+template <typename T>
+auto SegmentedQueue<T>::try_dequeue() -> std::optional<T> {
+    auto item = std::optional<T>();
+    claim(1, [&item](T&& value) { item.emplace(std::move(value)); });
+    return item;
+}
+
+template <typename T>
+template <typename OutputIt>
+auto SegmentedQueue<T>::try_dequeue_bulk(OutputIt output, size_t max_items) -> size_t {
+    auto total = size_t(0);
+    while (total < max_items) {
+        auto claimed = claim(max_items - total, [&output](T&& value) { *output = std::move(value); ++output; });
+        if (claimed == 0) { break; }
+        total += claimed;
+    }
+
+    return total;
+}
+
+template <typename T>
+auto SegmentedQueue<T>::size() const -> size_t {
+    // every lap contains a single marker position that does not correspond to an item
+    auto to_items = [](size_t index) {
+        auto position = index >> shift;
+        return position - (position / lap);
+    };
+
+    auto tail_items = to_items(tail.index.load(std::memory_order_relaxed));
+    auto head_items = to_items(head.index.load(std::memory_order_relaxed));
+    return tail_items > head_items ? tail_items - head_items : 0;
+}
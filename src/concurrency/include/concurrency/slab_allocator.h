@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "concurrency/cache_line.h"
+
+// SlabArena is a thread local slab allocator for the small, short lived objects the runtime allocates on every
+// continuation (cells, callback storage, job boxes). Every thread owns an arena that carves fixed size blocks out of
+// large chunks, blocks are recycled through per size class free lists so steady state allocation never hits malloc.
+//  - Blocks are prefixed with a header naming their owning arena, a block freed by its owner goes straight back
+//    onto the owner's free list, a block freed by any other thread is pushed onto the owner's remote free stack
+//    (a lock-free Treiber stack), the owner reclaims remote frees in bulk once its local free list runs dry
+//  - An arena is reference counted by its outstanding blocks (plus one for the owning thread), when a thread exits
+//    its arena lives on until the last of its blocks is freed by some other thread
+//  - Requests larger than the largest size class are forwarded to the global operator new
+class SlabArena {
+public:
+    // the alignment of every block handed out by the arena
+    constexpr static size_t alignment = 16;
+
+    // allocate/deallocate route through the calling thread's arena, deallocate may be invoked from any thread
+    [[nodiscard]] static auto allocate(size_t size) -> void*;
+    static auto deallocate(void* block) noexcept -> void;
+
+    SlabArena(const SlabArena&) = delete;
+    SlabArena(SlabArena&&) = delete;
+    auto operator=(const SlabArena&) -> SlabArena& = delete;
+    auto operator=(SlabArena&&) -> SlabArena& = delete;
+
+private:
+    friend class LocalSlabArena;
+
+    struct alignas(alignment) BlockHeader {
+        SlabArena* owner;
+        size_t size_class;
+    };
+
+    // FreeBlock overlays the payload of a free block, free lists are intrusive
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    SlabArena() = default;
+    ~SlabArena() = default;
+
+    [[nodiscard]] static auto size_class_for(size_t size) -> size_t;
+    [[nodiscard]] static auto header_of(void* block) -> BlockHeader*;
+
+    [[nodiscard]] auto allocate_block(size_t size_class) -> void*;
+    [[nodiscard]] auto carve_block(size_t size_class) -> void*;
+    auto free_local(void* block, size_t size_class) -> void;
+    auto free_remote(void* block) -> void;
+    auto reclaim_remote_frees() -> bool;
+
+    // release drops a reference to the arena (either a block or the owning thread's), the last reference deletes it
+    auto release() -> void;
+
+    constexpr static size_t chunk_size = size_t(64) * 1024;
+    constexpr static std::array<size_t, 6> size_classes = { 32, 64, 128, 256, 512, 1024 };
+    constexpr static size_t large_size_class = size_classes.size();
+
+    // owner only state
+    std::array<FreeBlock*, size_classes.size()> free_lists = {};
+    std::vector<std::unique_ptr<std::byte[]>> chunks;
+    std::byte* chunk_cursor = nullptr;
+    std::byte* chunk_end = nullptr;
+
+    // shared state, remote_frees is pushed to by other threads and drained by the owner
+    alignas(cache_line_size) std::atomic<FreeBlock*> remote_frees = { nullptr };
+    alignas(cache_line_size) std::atomic<size_t> references = { 1 };
+};
+
+
+// SlabAllocator adapts the calling thread's SlabArena to the standard Allocator requirements, it is stateless and any
+// two SlabAllocators compare equal as memory allocated by one thread's arena may be freed by any other thread
+template <typename T>
+class SlabAllocator {
+public:
+    using value_type = T;
+
+    SlabAllocator() = default;
+    template <typename U>
+    // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+    SlabAllocator(const SlabAllocator<U>& /* other */) noexcept {}
+
+    [[nodiscard]] auto allocate(size_t n) -> T* {
+        static_assert(alignof(T) <= SlabArena::alignment, "SlabAllocator does not support over-aligned types");
+        return static_cast<T*>(SlabArena::allocate(n * sizeof(T)));
+    }
+
+    auto deallocate(T* block, size_t /* n */) noexcept -> void { SlabArena::deallocate(block); }
+
+    template <typename U>
+    auto operator==(const SlabAllocator<U>& /* other */) const -> bool { return true; }
+};
@@ -7,6 +7,9 @@ public:
     auto lock() -> void;
     auto unlock() -> void;
 
+    // try_lock acquires the lock only if it is free, it never spins
+    [[nodiscard]] auto try_lock() -> bool;
+
 private:
     std::atomic<bool> is_acquired = { false };
 };
\ No newline at end of file
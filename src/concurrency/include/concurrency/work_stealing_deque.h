@@ -0,0 +1,251 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "concurrency/cache_line.h"
+
+// WorkStealingDeque is a lock-free Chase-Lev deque (Chase & Lev, "Dynamic Circular Work-Stealing Deque" using the
+// C11 memory orderings from Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models").
+//  - The deque has a single owner, the owner pushes to and pops from the bottom of the deque (LIFO)
+//  - Any number of thieves can concurrently steal from the top of the deque (FIFO), thieves race each other (and
+//    the owner when a single element remains) via a CAS on the top index
+//
+// push and pop must ONLY be invoked by the owning thread, steal and size may be invoked from any thread.
+//
+// Items are boxed, the ring buffer only ever stores pointers. A thief reads a slot before it knows whether it has won
+// the race for that slot, boxing the items means that speculative read is a plain atomic pointer load rather than a
+// racy copy of some arbitrary T. Boxes are obtained from Allocator, as boxes are freed by whichever thread takes the
+// item the allocator must support deallocation from any thread.
+template <typename T, typename Allocator = std::allocator<T>>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t base_capacity);
+    WorkStealingDeque() : WorkStealingDeque(default_capacity) {}
+    ~WorkStealingDeque();
+
+    WorkStealingDeque(WorkStealingDeque& other) = delete;
+    WorkStealingDeque(WorkStealingDeque&& other) = delete;
+    auto operator=(WorkStealingDeque& other) -> WorkStealingDeque& = delete;
+    auto operator=(WorkStealingDeque&& other) -> WorkStealingDeque& = delete;
+
+    // push/pop operate on the bottom of the deque and may only be called by the owner
+    auto push(T&& item) -> void;
+
+    // push_bulk pushes count items from items onto the bottom of the deque, the deque grows at most once and the
+    // items are published to thieves with a single update of the bottom index
+    template <typename InputIt>
+    auto push_bulk(InputIt items, size_t count) -> void;
+    [[nodiscard]] auto pop() -> std::optional<T>;
+
+    // steal takes an item from the top of the deque, it returns std::nullopt if the deque was empty or
+    // if the thief lost the race for the top element
+    [[nodiscard]] auto steal() -> std::optional<T>;
+
+    // Note: size is only approximate when observed by a thread other than the owner
+    [[nodiscard]] auto size() const -> size_t;
+
+    // reserve grows the deque so it can hold at least capacity items without growing, it may only be called by the owner.
+    // As the ring buffer is allocated (and first touched) by the calling thread, an owner pinned to a NUMA node can
+    // construct the deque small and reserve its working capacity from its own thread to keep the buffer node local
+    auto reserve(size_t capacity) -> void;
+
+private:
+    using AllocatorTraits = std::allocator_traits<Allocator>;
+
+    // box/unbox move an item into and out of storage obtained from the allocator
+    [[nodiscard]] auto box(T&& item) -> T*;
+    [[nodiscard]] auto unbox(T* boxed) -> T;
+
+    // RingBuffer is a power of two sized circular array of boxed items, indices are never wrapped by the caller
+    // instead the ring buffer masks them on access
+    class RingBuffer {
+    public:
+        explicit RingBuffer(size_t capacity) : mask(capacity - 1), slots(capacity) {}
+
+        [[nodiscard]] auto capacity() const -> int64_t { return static_cast<int64_t>(slots.size()); }
+        [[nodiscard]] auto load(int64_t index) const -> T* {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_acquire);
+        }
+
+        auto store(int64_t index, T* item) -> void {
+            slots[static_cast<size_t>(index) & mask].store(item, std::memory_order_release);
+        }
+
+        // grow creates a new ring buffer of the given (power of two) capacity containing the live range [top, bottom)
+        [[nodiscard]] auto grow(int64_t bottom, int64_t top, size_t capacity) const -> std::unique_ptr<RingBuffer> {
+            auto grown = std::make_unique<RingBuffer>(capacity);
+            for (auto index = top; index < bottom; index += 1) {
+                grown->store(index, load(index));
+            }
+
+            return grown;
+        }
+
+    private:
+        size_t mask;
+        std::vector<std::atomic<T*>> slots;
+    };
+
+    // grow_to_fit ensures the ring buffer can hold count more items, returning the (possibly new) ring buffer
+    [[nodiscard]] auto grow_to_fit(int64_t bottom_index, int64_t top_index, size_t count) -> RingBuffer*;
+
+    const static size_t default_capacity = 1024;
+
+    // top is written by thieves and bottom by the owner, keep them on separate cache lines to prevent false sharing
+    alignas(cache_line_size) std::atomic<int64_t> top = { 0 };
+    alignas(cache_line_size) std::atomic<int64_t> bottom = { 0 };
+    alignas(cache_line_size) std::atomic<RingBuffer*> buffer;
+
+    // buffers owns every ring buffer ever allocated by the deque, when the deque grows the old buffer cannot be freed
+    // as a thief may still be reading from it. Retired buffers are kept alive until the deque is destroyed, since the
+    // deque grows geometrically this at most doubles the memory held by the deque. Only ever touched by the owner.
+    std::vector<std::unique_ptr<RingBuffer>> buffers;
+    [[no_unique_address]] Allocator allocator;
+};
+
+
+
+
+
+
+
+// Implementation
+template <typename T, typename Allocator>
+WorkStealingDeque<T, Allocator>::WorkStealingDeque(size_t base_capacity) {
+    // round the base capacity up to a power of two so that indices can be masked
+    auto capacity = size_t(1);
+    while (capacity < base_capacity) { capacity *= 2; }
+
+    buffers.push_back(std::make_unique<RingBuffer>(capacity));
+    buffer.store(buffers.back().get(), std::memory_order_relaxed);
+}
+
+template <typename T, typename Allocator>
+WorkStealingDeque<T, Allocator>::~WorkStealingDeque() {
+    auto* ring_buffer = buffer.load(std::memory_order_relaxed);
+    auto bottom_index = bottom.load(std::memory_order_relaxed);
+    for (auto index = top.load(std::memory_order_relaxed); index < bottom_index; index += 1) {
+        static_cast<void>(unbox(ring_buffer->load(index)));
+    }
+}
+
+template <typename T, typename Allocator>
+auto WorkStealingDeque<T, Allocator>::push(T&& item) -> void {
+    auto bottom_index = bottom.load(std::memory_order_relaxed);
+    auto top_index = top.load(std::memory_order_acquire);
+    auto* ring_buffer = grow_to_fit(bottom_index, top_index, 1);
+
+    ring_buffer->store(bottom_index, box(std::move(item)));
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(bottom_index + 1, std::memory_order_relaxed);
+}
+
+template <typename T, typename Allocator>
+template <typename InputIt>
+auto WorkStealingDeque<T, Allocator>::push_bulk(InputIt items, size_t count) -> void {
+    auto bottom_index = bottom.load(std::memory_order_relaxed);
+    auto top_index = top.load(std::memory_order_acquire);
+    auto* ring_buffer = grow_to_fit(bottom_index, top_index, count);
+
+    for (auto index = bottom_index; index < bottom_index + static_cast<int64_t>(count); index += 1, ++items) {
+        ring_buffer->store(index, box(std::move(*items)));
+    }
+
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(bottom_index + static_cast<int64_t>(count), std::memory_order_relaxed);
+}
+
+template <typename T, typename Allocator>
+auto WorkStealingDeque<T, Allocator>::reserve(size_t capacity) -> void {
+    auto bottom_index = bottom.load(std::memory_order_relaxed);
+    auto top_index = top.load(std::memory_order_acquire);
+    auto live = static_cast<size_t>(bottom_index - top_index);
+    static_cast<void>(grow_to_fit(bottom_index, top_index, capacity > live ? capacity - live : 0));
+}
+
+template <typename T, typename Allocator>
+auto WorkStealingDeque<T, Allocator>::grow_to_fit(int64_t bottom_index, int64_t top_index, size_t count) -> typename WorkStealingDeque<T, Allocator>::RingBuffer* {
+    auto* ring_buffer = buffer.load(std::memory_order_relaxed);
+    auto required = static_cast<size_t>(bottom_index - top_index) + count;
+    if (required <= static_cast<size_t>(ring_buffer->capacity())) {
+        return ring_buffer;
+    }
+
+    auto capacity = static_cast<size_t>(ring_buffer->capacity()) * 2;
+    while (capacity < required) { capacity *= 2; }
+
+    buffers.push_back(ring_buffer->grow(bottom_index, top_index, capacity));
+    ring_buffer = buffers.back().get();
+    buffer.store(ring_buffer, std::memory_order_release);
+    return ring_buffer;
+}
+
+template <typename T, typename Allocator>
+auto WorkStealingDeque<T, Allocator>::pop() -> std::optional<T> {
+    auto bottom_index = bottom.load(std::memory_order_relaxed) - 1;
+    auto* ring_buffer = buffer.load(std::memory_order_relaxed);
+    bottom.store(bottom_index, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto top_index = top.load(std::memory_order_relaxed);
+
+    // the deque was empty, restore the bottom index
+    if (top_index > bottom_index) {
+        bottom.store(bottom_index + 1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    auto* item = ring_buffer->load(bottom_index);
+    if (top_index == bottom_index) {
+        // this is the last item in the deque, we must race any thieves for it
+        auto won_race = top.compare_exchange_strong(top_index, top_index + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(bottom_index + 1, std::memory_order_relaxed);
+        if (!won_race) { return std::nullopt; }
+    }
+
+    return std::optional<T>(unbox(item));
+}
+
+template <typename T, typename Allocator>
+auto WorkStealingDeque<T, Allocator>::steal() -> std::optional<T> {
+    auto top_index = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto bottom_index = bottom.load(std::memory_order_acquire);
+
+    if (top_index >= bottom_index) {
+        return std::nullopt;
+    }
+
+    auto* item = buffer.load(std::memory_order_acquire)->load(top_index);
+    if (!top.compare_exchange_strong(top_index, top_index + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return std::nullopt;
+    }
+
+    return std::optional<T>(unbox(item));
+}
+
+template <typename T, typename Allocator>
+auto WorkStealingDeque<T, Allocator>::size() const -> size_t {
+    auto bottom_index = bottom.load(std::memory_order_relaxed);
+    auto top_index = top.load(std::memory_order_relaxed);
+    return bottom_index > top_index ? static_cast<size_t>(bottom_index - top_index) : 0;
+}
+
+template <typename T, typename Allocator>
+auto WorkStealingDeque<T, Allocator>::box(T&& item) -> T* {
+    auto* boxed = AllocatorTraits::allocate(allocator, 1);
+    AllocatorTraits::construct(allocator, boxed, std::move(item));
+    return boxed;
+}
+
+template <typename T, typename Allocator>
+auto WorkStealingDeque<T, Allocator>::unbox(T* boxed) -> T {
+    auto item = T(std::move(*boxed));
+    AllocatorTraits::destroy(allocator, boxed);
+    AllocatorTraits::deallocate(allocator, boxed, 1);
+    return item;
+}
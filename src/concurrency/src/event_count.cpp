@@ -0,0 +1,80 @@
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "concurrency/event_count.h"
+
+namespace {
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-vararg,hicpp-vararg,cppcoreguidelines-pro-type-reinterpret-cast)
+    //  - Note: the futex syscall is only exposed through the variadic syscall() function and takes the address of the
+    //          underlying integer, std::atomic<uint32_t> is guaranteed to be layout compatible with uint32_t on Linux
+    auto futex_wait(std::atomic<uint32_t>& word, uint32_t expected) -> void {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    // futex_wait_for returns false if the timeout elapsed, the timeout of FUTEX_WAIT is relative
+    auto futex_wait_for(std::atomic<uint32_t>& word, uint32_t expected, std::chrono::nanoseconds timeout) -> bool {
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+        auto relative = timespec { .tv_sec = seconds.count(), .tv_nsec = (timeout - seconds).count() };
+        auto result = syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, &relative, nullptr, 0);
+        return result == 0 || errno != ETIMEDOUT;
+    }
+
+    auto futex_wake(std::atomic<uint32_t>& word, uint32_t n) -> void {
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, n, nullptr, nullptr, 0);
+    }
+    // NOLINTEND(cppcoreguidelines-pro-type-vararg,hicpp-vararg,cppcoreguidelines-pro-type-reinterpret-cast)
+}
+
+auto EventCount::prepare_wait() -> Key {
+    num_waiters.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return epoch.load(std::memory_order_acquire);
+}
+
+auto EventCount::cancel_wait() -> void { num_waiters.fetch_sub(1, std::memory_order_seq_cst); }
+
+auto EventCount::wait(Key key) -> void {
+    // the futex only sleeps if the epoch still matches the key, a notification between prepare_wait and wait
+    // will hence cause us to return immediately
+    while (epoch.load(std::memory_order_acquire) == key) {
+        futex_wait(epoch, key);
+    }
+
+    num_waiters.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+auto EventCount::wait_for(Key key, std::chrono::nanoseconds timeout) -> bool {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto notified = true;
+    while (epoch.load(std::memory_order_acquire) == key) {
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::nanoseconds::zero() || !futex_wait_for(epoch, key, remaining)) {
+            notified = epoch.load(std::memory_order_acquire) != key;
+            break;
+        }
+    }
+
+    num_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    return notified;
+}
+
+auto EventCount::notify(uint32_t n) -> void {
+    // pairs with the fence in prepare_wait, either the waiter observes the producer's condition or we observe the waiter
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (n == 0 || num_waiters.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    epoch.fetch_add(1, std::memory_order_release);
+    futex_wake(epoch, n);
+}
+
+auto EventCount::notify_all() -> void { notify(static_cast<uint32_t>(INT_MAX)); }
+auto EventCount::waiters() const -> uint32_t { return num_waiters.load(std::memory_order_relaxed); }
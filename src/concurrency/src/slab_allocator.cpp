@@ -0,0 +1,144 @@
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#include "concurrency/slab_allocator.h"
+
+namespace {
+    // current_arena is the arena owned by this thread (if it has one), it is a plain pointer so that it remains
+    // readable while the thread's other thread_local objects are being destroyed
+    thread_local SlabArena* current_arena = nullptr;
+    thread_local bool arena_destroyed = false;
+}
+
+// LocalSlabArena owns the calling thread's reference to its arena, the arena is created lazily upon the first
+// allocation and released when the thread exits. Allocations made after this point (ie. by thread_local destructors)
+// are forwarded to the global operator new.
+class LocalSlabArena {
+public:
+    LocalSlabArena() : arena(new SlabArena()) { current_arena = arena; } // NOLINT(cppcoreguidelines-owning-memory)
+    ~LocalSlabArena() {
+        current_arena = nullptr;
+        arena_destroyed = true;
+        arena->release();
+    }
+
+    LocalSlabArena(const LocalSlabArena&) = delete;
+    LocalSlabArena(LocalSlabArena&&) = delete;
+    auto operator=(const LocalSlabArena&) -> LocalSlabArena& = delete;
+    auto operator=(LocalSlabArena&&) -> LocalSlabArena& = delete;
+
+    [[nodiscard]] static auto get() -> SlabArena* {
+        if (current_arena == nullptr && !arena_destroyed) {
+            thread_local auto local_arena = LocalSlabArena();
+        }
+
+        return current_arena;
+    }
+
+private:
+    SlabArena* arena;
+};
+
+
+auto SlabArena::allocate(size_t size) -> void* {
+    auto size_class = size_class_for(size);
+    auto* arena = size_class == large_size_class ? nullptr : LocalSlabArena::get();
+    if (arena == nullptr) {
+        auto* header = ::new (::operator new(sizeof(BlockHeader) + size)) BlockHeader { nullptr, large_size_class };
+        return header + 1; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    return arena->allocate_block(size_class);
+}
+
+auto SlabArena::deallocate(void* block) noexcept -> void {
+    if (block == nullptr) { return; }
+
+    auto* header = header_of(block);
+    auto* owner = header->owner;
+    if (owner == nullptr) {
+        ::operator delete(header);
+    } else if (owner == current_arena) {
+        owner->free_local(block, header->size_class);
+    } else {
+        owner->free_remote(block);
+    }
+}
+
+auto SlabArena::size_class_for(size_t size) -> size_t {
+    auto size_class = size_t(0);
+    while (size_class < size_classes.size() && size_classes.at(size_class) < size) { size_class += 1; }
+    return size_class;
+}
+
+auto SlabArena::header_of(void* block) -> BlockHeader* {
+    return static_cast<BlockHeader*>(block) - 1; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+auto SlabArena::allocate_block(size_t size_class) -> void* {
+    references.fetch_add(1, std::memory_order_relaxed);
+
+    auto*& free_list = free_lists.at(size_class);
+    if (free_list == nullptr) { reclaim_remote_frees(); }
+    if (free_list != nullptr) {
+        auto* block = free_list;
+        free_list = block->next;
+        return block;
+    }
+
+    return carve_block(size_class);
+}
+
+// carve_block takes a fresh block from the current chunk, allocating a new chunk if the current one is exhausted
+auto SlabArena::carve_block(size_t size_class) -> void* {
+    auto block_size = sizeof(BlockHeader) + size_classes.at(size_class);
+    if (chunk_cursor == nullptr || static_cast<size_t>(chunk_end - chunk_cursor) < block_size) {
+        chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(chunk_size)); // NOLINT(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+        chunk_cursor = chunks.back().get();
+        chunk_end = chunk_cursor + chunk_size; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    }
+
+    auto* header = ::new (chunk_cursor) BlockHeader { this, size_class };
+    chunk_cursor += block_size; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return header + 1; // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+// free_local is only ever invoked by the owning thread, as the owning thread holds a reference of its own
+// dropping the block's reference can never delete the arena
+auto SlabArena::free_local(void* block, size_t size_class) -> void {
+    auto*& free_list = free_lists.at(size_class);
+    free_list = ::new (block) FreeBlock { free_list };
+    references.fetch_sub(1, std::memory_order_relaxed);
+}
+
+auto SlabArena::free_remote(void* block) -> void {
+    auto* free_block = ::new (block) FreeBlock { remote_frees.load(std::memory_order_relaxed) };
+    while (!remote_frees.compare_exchange_weak(free_block->next, free_block, std::memory_order_release, std::memory_order_relaxed)) {}
+
+    release();
+}
+
+// reclaim_remote_frees takes every block on the remote free stack and places it on its size class' free list, as the
+// owner is the only thread that pops from the stack taking the entire stack at once is not subject to ABA
+auto SlabArena::reclaim_remote_frees() -> bool {
+    auto* block = remote_frees.exchange(nullptr, std::memory_order_acquire);
+    auto reclaimed_any = block != nullptr;
+
+    while (block != nullptr) {
+        auto* next = block->next;
+        auto*& free_list = free_lists.at(header_of(block)->size_class);
+        block->next = free_list;
+        free_list = block;
+        block = next;
+    }
+
+    return reclaimed_any;
+}
+
+auto SlabArena::release() -> void {
+    if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this; // NOLINT(cppcoreguidelines-owning-memory)
+    }
+}
@@ -24,4 +24,8 @@ auto SpinLock::lock() -> void {
     }
 }
 
+auto SpinLock::try_lock() -> bool {
+    return !is_acquired.load(std::memory_order_relaxed) && !is_acquired.exchange(true, std::memory_order_acquire);
+}
+
 auto SpinLock::unlock() -> void { is_acquired.store(false, std::memory_order_release); }
\ No newline at end of file
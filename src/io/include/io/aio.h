@@ -11,22 +11,21 @@
 namespace IO {
     class InFlightAIORequest {
     public:
-        InFlightAIORequest(ReadRequest request, std::shared_ptr<struct aiocb> control_block)
+        InFlightAIORequest(ReadRequest request, std::unique_ptr<struct aiocb> control_block)
             : request(std::move(request)),
               control_block(std::move(control_block)) {}
 
         [[nodiscard]] auto result() const -> AIOResult<ReadRequest>;
-        [[nodiscard]] auto aio_control_block() const -> const std::shared_ptr<struct aiocb>&;
+        [[nodiscard]] auto aio_control_block() const -> struct aiocb*;
 
         auto is_completed() -> bool;
 
     private:
         // Implementation note:
-        // The control block is a shared_ptr as the intention is that it will be accessed by callbacks
-        // upon a completed IO job. This forces us to use a shared_ptr as std::function and hence Scheduler::Job
-        // require the lambda to be copy constructible. This is not possible with a lambda capturing a unique_ptr.
+        // The control block is uniquely owned by the request, the request is moved into the Scheduler::Job that
+        // handles its completion. Scheduler::Job is move-only so the completion job may own the control block outright.
         ReadRequest request;
-        std::shared_ptr<struct aiocb> control_block;
+        std::unique_ptr<struct aiocb> control_block;
     };
 
 
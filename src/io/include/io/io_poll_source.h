@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <optional>
 #include <vector>
 #include <chrono>
 #include <memory>
@@ -16,17 +19,36 @@ using std::chrono_literals::operator""ms;
 // NOTE: This class repeatedly polls the state of various IO jobs via a syscall
 // this is probably not ideal and in the future should be upgraded to use a more
 // efficient mechanism, aio allows us to suspend a thread until a tracked job is complete
-// perhaps we can use this to avoid polling
+// perhaps we can use this to avoid polling. The source is only polled while requests are
+// in flight, queueing a read onto an idle source wakes the poll thread.
 namespace IO {
     class PollSource : public Scheduler::IPollSource {
     public:
         using Callback = std::function<void(IO::AIOResult<IO::ReadRequest>)>;
+        using RequestId = uint64_t;
+
         auto poll_frequency() -> std::chrono::milliseconds override { return 5ms; };
         auto poll() -> std::vector<Scheduler::Job> override;
-        auto queue_read(FILE* file, IO::ReadRequest request, const Callback& callback) -> void;
+        auto next_poll() -> std::optional<TimePoint> override;
+        auto attach(Scheduler::IPollWaker* poller) -> void override { waker.store(poller, std::memory_order_release); }
+        auto queue_read(FILE* file, IO::ReadRequest request, const Callback& callback) -> RequestId;
+
+        // cancel aio_cancels an in flight read, its callback is dropped and never invoked. A read that aio could not
+        // cancel (it is already being serviced) stays in flight until it completes as its buffer is still being written
+        // to, it is then discarded. Returns false if the read has already been handed to its callback (or been cancelled)
+        auto cancel(RequestId id) -> bool;
 
     private:
+        struct InFlightRead {
+            RequestId id;
+            Callback callback;
+            InFlightAIORequest request;
+            bool cancelled;
+        };
+
         SpinLock spinlock;
-        std::vector<std::pair<Callback, InFlightAIORequest>> in_flight_requests;
+        std::vector<InFlightRead> in_flight_requests;
+        RequestId next_request_id = 0;
+        std::atomic<Scheduler::IPollWaker*> waker = { nullptr };
     };
 }
\ No newline at end of file
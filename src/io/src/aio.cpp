@@ -35,8 +35,8 @@ auto IO::InFlightAIORequest::result() const -> IO::AIOResult<IO::ReadRequest> {
     return { parsed_status };
 }
 
-auto IO::InFlightAIORequest::aio_control_block() const -> const std::shared_ptr<struct aiocb>& {
-    return control_block;
+auto IO::InFlightAIORequest::aio_control_block() const -> struct aiocb* {
+    return control_block.get();
 }
 
 auto IO::AIOManager::enqueue_and_start_read(FILE* file, IO::ReadRequest request) -> InFlightAIORequest {
@@ -46,7 +46,7 @@ auto IO::AIOManager::enqueue_and_start_read(FILE* file, IO::ReadRequest request)
 // is relatively large.
     auto aio_request = InFlightAIORequest(
         request,
-        std::make_shared<struct aiocb>(aiocb {
+        std::make_unique<struct aiocb>(aiocb {
             .aio_fildes = file->_fileno,
             .aio_lio_opcode = LIO_READ,
             .aio_buf = request.underlying_buffer().get(),
@@ -56,6 +56,6 @@ auto IO::AIOManager::enqueue_and_start_read(FILE* file, IO::ReadRequest request)
     );
 #pragma GCC diagnostic pop
 
-    aio_read(aio_request.aio_control_block().get());
+    aio_read(aio_request.aio_control_block());
     return aio_request;
 }
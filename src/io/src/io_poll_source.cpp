@@ -1,7 +1,12 @@
+#include <atomic>
+#include <chrono>
 #include <mutex>
+#include <optional>
 #include <vector>
 #include <utility>
 #include <cstdio>
+#include <algorithm>
+#include <aio.h>
 
 #include "io/io_poll_source.h"
 #include "io/io_request.h"
@@ -16,16 +21,16 @@
 auto IO::PollSource::poll() -> std::vector<Scheduler::Job> {                
     const auto lock = std::lock_guard<SpinLock>(spinlock);
     auto completed_jobs = std::vector<Scheduler::Job>();
-    auto pending_requests = std::vector<std::pair<Callback, InFlightAIORequest>>();
+    auto pending_requests = std::vector<InFlightRead>();
 
-    for (auto& [callback, request] : in_flight_requests) {
-        if (request.is_completed()) {
-            completed_jobs.emplace_back([callback=callback, request = std::move(request)](UNUSED(auto ctx)) {
+    for (auto& in_flight : in_flight_requests) {
+        if (!in_flight.request.is_completed()) {
+            pending_requests.push_back(std::move(in_flight));
+        } else if (!in_flight.cancelled) {
+            completed_jobs.emplace_back([callback = std::move(in_flight.callback), request = std::move(in_flight.request)](UNUSED(auto ctx)) {
                 auto underlying = request.result();
                 callback(underlying);
             });
-        } else {
-            pending_requests.emplace_back(callback, std::move(request));
         }
     }
 
@@ -35,9 +40,46 @@ auto IO::PollSource::poll() -> std::vector<Scheduler::Job> {
 };
 
 
-auto IO::PollSource::queue_read(FILE* file, IO::ReadRequest request, const Callback& callback) -> void {
+auto IO::PollSource::queue_read(FILE* file, IO::ReadRequest request, const Callback& callback) -> RequestId {
     auto in_flight_request = AIOManager::enqueue_and_start_read(file, std::move(request));
 
+    auto was_idle = false;
+    auto id = RequestId(0);
+    {
+        const auto lock = std::lock_guard<SpinLock>(spinlock);
+        was_idle = in_flight_requests.empty();
+        id = next_request_id++;
+        in_flight_requests.push_back({ id, callback, std::move(in_flight_request), /* cancelled = */ false });
+    }
+
+    if (auto* poller = waker.load(std::memory_order_acquire); was_idle && poller != nullptr) { poller->wake(); }
+    return id;
+}
+
+// the cancelled read (its callback and its buffer) is destroyed once the lock is released
+auto IO::PollSource::cancel(RequestId id) -> bool {
+    auto cancelled = std::optional<InFlightRead>();
+    {
+        const auto lock = std::lock_guard<SpinLock>(spinlock);
+        auto in_flight = std::ranges::find_if(in_flight_requests, [id](const auto& in_flight) { return in_flight.id == id; });
+        if (in_flight == in_flight_requests.end() || in_flight->cancelled) { return false; }
+
+        auto* control_block = in_flight->request.aio_control_block();
+        if (aio_cancel(control_block->aio_fildes, control_block) == AIO_NOTCANCELED) {
+            in_flight->cancelled = true;
+            in_flight->callback = nullptr;
+            return true;
+        }
+
+        cancelled = std::move(*in_flight);
+        in_flight_requests.erase(in_flight);
+    }
+
+    return true;
+}
+
+auto IO::PollSource::next_poll() -> std::optional<TimePoint> {
     const auto lock = std::lock_guard<SpinLock>(spinlock);
-    in_flight_requests.emplace_back(callback, std::move(in_flight_request));
+    if (in_flight_requests.empty()) { return std::nullopt; }
+    return std::chrono::steady_clock::now() + poll_frequency();
 }
\ No newline at end of file
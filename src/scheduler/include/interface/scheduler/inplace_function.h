@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// InplaceFunction is a move-only, type-erased callable with an inline buffer of Capacity bytes. Unlike std::function
+// it does not require the callable to be copyable (so continuations may own unique resources) and any callable that
+// fits in the buffer is stored without a heap allocation. Callables that do not fit (or that could throw on a move)
+// fall back to being boxed on the heap, check InplaceFunction::stored_inline<F> to determine which path a callable takes.
+namespace Scheduler {
+    template <typename Signature, size_t Capacity>
+    class InplaceFunction;
+
+    template <typename R, typename... Args, size_t Capacity>
+    class InplaceFunction<R(Args...), Capacity> {
+    public:
+        template <typename F>
+        constexpr static bool stored_inline = sizeof(F) <= Capacity
+                                           && alignof(F) <= alignof(void*)
+                                           && std::is_nothrow_move_constructible_v<F>;
+
+        InplaceFunction() = default;
+        // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions)
+        InplaceFunction(std::nullptr_t) {}
+
+        // NOLINTNEXTLINE(google-explicit-constructor,hicpp-explicit-conversions,bugprone-forwarding-reference-overload)
+        template <typename F> requires (!std::same_as<std::remove_cvref_t<F>, InplaceFunction> && std::invocable<std::decay_t<F>&, Args...>)
+        InplaceFunction(F&& callable);
+
+        ~InplaceFunction() { reset(); }
+
+        InplaceFunction(InplaceFunction&& other) noexcept;
+        auto operator=(InplaceFunction&& other) noexcept -> InplaceFunction&;
+        InplaceFunction(const InplaceFunction&) = delete;
+        auto operator=(const InplaceFunction&) -> InplaceFunction& = delete;
+
+        // Note: like std::function, invoking an InplaceFunction is const even though the stored callable may mutate itself
+        auto operator()(Args... args) const -> R { return vtable->invoke(storage.data(), std::forward<Args>(args)...); }
+        explicit operator bool() const { return vtable != nullptr; }
+
+    private:
+        // VTable holds the type-erased operations for some callable, move constructs the callable into uninitialised
+        // storage and destroys the source, hence a moved from InplaceFunction holds nothing
+        struct VTable {
+            R (*invoke)(std::byte* storage, Args&&... args);
+            void (*move)(std::byte* from, std::byte* to) noexcept;
+            void (*destroy)(std::byte* storage) noexcept;
+        };
+
+        template <typename F>
+        [[nodiscard]] static auto as_inline(std::byte* storage) -> F* { return std::launder(reinterpret_cast<F*>(storage)); } // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+        template <typename F>
+        [[nodiscard]] static auto as_boxed(std::byte* storage) -> F*& { return *std::launder(reinterpret_cast<F**>(storage)); } // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+        template <typename F>
+        constexpr static VTable inline_vtable = {
+            .invoke = [](std::byte* storage, Args&&... args) -> R { return std::invoke(*as_inline<F>(storage), std::forward<Args>(args)...); },
+            .move = [](std::byte* from, std::byte* to) noexcept {
+                ::new (static_cast<void*>(to)) F(std::move(*as_inline<F>(from)));
+                std::destroy_at(as_inline<F>(from));
+            },
+            .destroy = [](std::byte* storage) noexcept { std::destroy_at(as_inline<F>(storage)); },
+        };
+
+        template <typename F>
+        constexpr static VTable boxed_vtable = {
+            .invoke = [](std::byte* storage, Args&&... args) -> R { return std::invoke(*as_boxed<F>(storage), std::forward<Args>(args)...); },
+            .move = [](std::byte* from, std::byte* to) noexcept { ::new (static_cast<void*>(to)) F*(std::exchange(as_boxed<F>(from), nullptr)); },
+            .destroy = [](std::byte* storage) noexcept { delete as_boxed<F>(storage); }, // NOLINT(cppcoreguidelines-owning-memory)
+        };
+
+        auto reset() -> void;
+
+        // storage is mutable as invoking the callable is a const operation on the InplaceFunction itself
+        alignas(void*) mutable std::array<std::byte, Capacity> storage = {};
+        const VTable* vtable = nullptr;
+    };
+}
+
+
+
+
+
+
+
+// Implementation
+template <typename R, typename... Args, size_t Capacity>
+template <typename F> requires (!std::same_as<std::remove_cvref_t<F>, Scheduler::InplaceFunction<R(Args...), Capacity>> && std::invocable<std::decay_t<F>&, Args...>)
+Scheduler::InplaceFunction<R(Args...), Capacity>::InplaceFunction(F&& callable) {
+    using Callable = std::decay_t<F>;
+    static_assert(Capacity >= sizeof(void*), "InplaceFunction must be able to hold at least a boxed callable");
+
+    if constexpr (stored_inline<Callable>) {
+        ::new (static_cast<void*>(storage.data())) Callable(std::forward<F>(callable));
+        vtable = &inline_vtable<Callable>;
+    } else {
+        ::new (static_cast<void*>(storage.data())) Callable*(new Callable(std::forward<F>(callable))); // NOLINT(cppcoreguidelines-owning-memory)
+        vtable = &boxed_vtable<Callable>;
+    }
+}
+
+template <typename R, typename... Args, size_t Capacity>
+Scheduler::InplaceFunction<R(Args...), Capacity>::InplaceFunction(InplaceFunction&& other) noexcept : vtable(std::exchange(other.vtable, nullptr)) {
+    if (vtable != nullptr) { vtable->move(other.storage.data(), storage.data()); }
+}
+
+template <typename R, typename... Args, size_t Capacity>
+auto Scheduler::InplaceFunction<R(Args...), Capacity>::operator=(InplaceFunction&& other) noexcept -> InplaceFunction& {
+    if (this == &other) { return *this; }
+
+    reset();
+    vtable = std::exchange(other.vtable, nullptr);
+    if (vtable != nullptr) { vtable->move(other.storage.data(), storage.data()); }
+    return *this;
+}
+
+template <typename R, typename... Args, size_t Capacity>
+auto Scheduler::InplaceFunction<R(Args...), Capacity>::reset() -> void {
+    if (vtable != nullptr) {
+        vtable->destroy(storage.data());
+        vtable = nullptr;
+    }
+}
@@ -1,9 +1,14 @@
 #pragma once
 
-#include <functional>
+#include <cstddef>
 
+#include "scheduler/inplace_function.h"
 #include "scheduler/scheduling_context.h"
 
 namespace Scheduler {
-    using Job = std::function<void(Context)>;
+    // job_capacity is the number of bytes a job's captures may occupy before the job is boxed on the heap, it is sized to
+    // hold a cell continuation (see Cell::Callback) alongside the result it is being resumed with
+    constexpr size_t job_capacity = 96;
+
+    using Job = InplaceFunction<void(Context), job_capacity>;
 }
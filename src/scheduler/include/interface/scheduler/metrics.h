@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "scheduler/scheduling_context.h"
+
+// Metrics are recorded by the scheduler into per-worker counters and histograms that are only ever written by a single
+// thread at a time (typically the worker that owns them), recording is hence a relaxed load and store rather than an
+// atomic read-modify-write. Nothing is aggregated until the metrics are read, reading produces a snapshot (SchedulerMetrics)
+// which can also be rendered in the Prometheus text exposition format.
+// Metrics are compiled out entirely unless ASYNC_LIB_METRICS is defined (see the ASYNC_LIB_METRICS CMake option), when
+// compiled out recording is a no-op and snapshots only contain queue depths and steal counts.
+namespace Scheduler {
+#ifdef ASYNC_LIB_METRICS
+    constexpr bool metrics_enabled = true;
+#else
+    constexpr bool metrics_enabled = false;
+#endif
+
+    // Counter is a monotonic counter with a single writer
+    class Counter {
+    public:
+        auto increment(uint64_t n = 1) -> void {
+            if constexpr (metrics_enabled) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+        }
+
+        [[nodiscard]] auto load() const -> uint64_t { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value = { 0 };
+    };
+
+    // HistogramSnapshot is a point in time copy of a Histogram, snapshots of several histograms can be merged.
+    // Values are bucketed log-linearly (in the style of an HDR histogram): every power of two range is split into
+    // sub_buckets linear buckets, so any recorded value is reported within 1/sub_buckets (~6%) of its true value
+    struct HistogramSnapshot {
+        constexpr static size_t sub_bucket_bits = 4;
+        constexpr static size_t sub_buckets = size_t(1) << sub_bucket_bits;
+        // values are clamped to below 2^max_value_bits (for nanoseconds this is roughly 18 minutes)
+        constexpr static size_t max_value_bits = 40;
+        constexpr static size_t num_buckets = (max_value_bits - sub_bucket_bits + 1) * sub_buckets;
+
+        std::array<uint64_t, num_buckets> counts = {};
+        uint64_t sum = 0;
+
+        [[nodiscard]] static auto bucket_of(uint64_t value) -> size_t;
+        [[nodiscard]] static auto highest_value_in(size_t bucket) -> uint64_t;
+
+        auto merge(const HistogramSnapshot& other) -> void;
+        [[nodiscard]] auto count() const -> uint64_t;
+        [[nodiscard]] auto mean() const -> double;
+
+        // percentile returns the value below which the given fraction (0.0 to 1.0) of the recorded values fall
+        [[nodiscard]] auto percentile(double fraction) const -> uint64_t;
+    };
+
+    // Histogram records values with a single writer, see HistogramSnapshot for the bucketing
+    class Histogram {
+    public:
+        auto record(uint64_t value) -> void {
+            if constexpr (metrics_enabled) {
+                auto& bucket = counts.at(HistogramSnapshot::bucket_of(value));
+                bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                sum.store(sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+            }
+        }
+
+        [[nodiscard]] auto snapshot() const -> HistogramSnapshot;
+
+    private:
+        std::array<std::atomic<uint64_t>, HistogramSnapshot::num_buckets> counts = {};
+        std::atomic<uint64_t> sum = { 0 };
+    };
+
+    // WorkerMetrics is a snapshot of a single worker, queue_depth is indexed by priority and queue_latency is the time
+    // from a job being queued to it starting on this worker (sampled, see WorkerPool::queue_latency_sample_period)
+    struct WorkerMetrics {
+        std::array<size_t, num_priorities> queue_depth;
+        uint64_t jobs_run;
+        uint64_t steals;
+        uint64_t stolen_jobs;
+        uint64_t failed_steals;
+        uint64_t parks;
+        HistogramSnapshot queue_latency;
+    };
+
+    struct PollSourceMetrics {
+        uint64_t polls;
+        HistogramSnapshot poll_duration;
+    };
+
+    // BlockingPoolMetrics is a snapshot of the scheduler's blocking pool (see BlockingPool), jobs_run counts every
+    // blocking job that has completed
+    struct BlockingPoolMetrics {
+        size_t threads;
+        size_t idle_threads;
+        size_t queue_depth;
+        uint64_t jobs_run;
+    };
+
+    // SchedulerMetrics is a snapshot of every metric of a scheduler, durations are recorded in nanoseconds
+    struct SchedulerMetrics {
+        // workers holds every worker slot of the pool, active_workers is the number of those that are currently running
+        std::vector<WorkerMetrics> workers;
+        size_t active_workers;
+        std::array<size_t, num_priorities> global_queue_depth;
+        std::vector<PollSourceMetrics> poll_sources;
+        BlockingPoolMetrics blocking_pool;
+
+        // queue_latency merges the queue latency histograms of every worker
+        [[nodiscard]] auto queue_latency() const -> HistogramSnapshot;
+
+        // to_prometheus renders the snapshot in the Prometheus text exposition format
+        [[nodiscard]] auto to_prometheus() const -> std::string;
+    };
+}
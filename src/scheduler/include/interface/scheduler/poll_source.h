@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <chrono>
+#include <optional>
 
 #include "scheduler/job.h"
 
@@ -11,13 +12,37 @@
 // note that scheduler jobs are distinct from async jobs, scheduler jobs take a scheduling context
 // used to run continuations on the correct worker thread
 namespace Scheduler {
+    // IPollWaker wakes the thread that polls a set of poll sources, the poll thread sleeps until the earliest next_poll
+    // of its sources hence a source must wake it whenever new work could move its next_poll earlier. wake may be invoked
+    // from any thread and is cheap when the poll thread has already been woken
+    class IPollWaker {
+    public:
+        virtual ~IPollWaker() = default;
+        virtual auto wake() -> void = 0;
+
+        IPollWaker() = default;
+        IPollWaker(IPollWaker&&) = delete;
+        IPollWaker(const IPollWaker&) = delete;
+
+        auto operator=(const IPollWaker&) -> IPollWaker& = delete;
+        auto operator=(IPollWaker&&) -> IPollWaker& = delete;
+    };
+
     class IPollSource {
     public:
+        using TimePoint = std::chrono::steady_clock::time_point;
+
         virtual ~IPollSource() = default;
 
         [[nodiscard]] virtual auto poll_frequency() -> std::chrono::milliseconds = 0;
         [[nodiscard]] virtual auto poll() -> std::vector<Job> = 0;
 
+        // next_poll is the time the source next needs to be polled, std::nullopt if the source has nothing to do until it
+        // wakes the poll thread. By default sources are polled every poll_frequency
+        [[nodiscard]] virtual auto next_poll() -> std::optional<TimePoint> { return std::chrono::steady_clock::now() + poll_frequency(); }
+
+        // attach hands the source the waker of the thread polling it (or nullptr once the thread stops polling it)
+        virtual auto attach(IPollWaker* /* waker */) -> void {}
 
         IPollSource() = default;
         IPollSource(IPollSource&&) = delete;
@@ -26,4 +51,4 @@ namespace Scheduler {
         auto operator=(const IPollSource&) -> IPollSource& = delete;
         auto operator=(IPollSource&&) -> IPollSource& = delete;
     };
-}
\ No newline at end of file
+}
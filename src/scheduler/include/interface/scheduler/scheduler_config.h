@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace Scheduler {
+    // SchedulerConfig configures the worker pool of a scheduler.
+    //  - pin_workers pins each worker thread to a logical CPU and orders the workers each worker steals from by how
+    //    close they are in the machine's topology (SMT siblings, then workers sharing a cache/NUMA node, then the rest),
+    //    only the CPUs the process is allowed to run on (taskset, cgroup cpusets) are used and pinning is best-effort, a
+    //    worker that cannot be pinned simply runs unpinned and steals from every other worker as a remote victim
+    //  - topology_file replaces the topology discovered from /sys/devices/system/cpu with a simulated one, this allows
+    //    topology aware stealing to be exercised on machines without that topology (see scheduler/topology.h)
+    //  - idle_worker_polling lets workers that run out of work poll the scheduler's due poll sources themselves, the
+    //    completions are queued onto the polling worker's own queue rather than handed over from the poll thread via
+    //    the global queue. The poll thread then only polls while no worker is idle
+    //  - max_workers makes the pool elastic, n_workers workers are always running and up to max_workers are spawned
+    //    while the pool is saturated: work is queued and no worker is searching for work or parked. A worker is spawned
+    //    once the pool has been saturated for grow_after (ie. jobs are waiting at least that long to start, which also
+    //    covers workers blocked in Task::block) or immediately once grow_queue_depth jobs per running worker are queued.
+    //    Workers beyond n_workers retire once they have been parked for idle_worker_timeout
+    //  - lifo_slot gives each worker a single slot holding the job it queued most recently, that job runs next (while its
+    //    inputs are still in cache) and cannot be stolen until it has waited for a short grace period, see JobWorker::push_lifo
+    //  - max_blocking_threads caps the threads of the blocking pool that runs blocking jobs (see IScheduler::queue_blocking),
+    //    its threads are spawned on demand and exit once idle for blocking_thread_idle_timeout
+    struct SchedulerConfig {
+        unsigned int n_workers;
+        bool pin_workers = false;
+        std::optional<std::string> topology_file = std::nullopt;
+        bool idle_worker_polling = true;
+        std::optional<unsigned int> max_workers = std::nullopt;
+        std::chrono::microseconds grow_after = std::chrono::milliseconds(1);
+        size_t grow_queue_depth = 256;
+        std::chrono::milliseconds idle_worker_timeout = std::chrono::seconds(10);
+        bool lifo_slot = true;
+        unsigned int max_blocking_threads = 64;
+        std::chrono::milliseconds blocking_thread_idle_timeout = std::chrono::seconds(10);
+    };
+}
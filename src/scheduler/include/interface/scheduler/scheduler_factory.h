@@ -5,8 +5,10 @@
 
 #include "scheduler/scheduler_intf.h"
 #include "scheduler/poll_source.h"
+#include "scheduler/scheduler_config.h"
 
 
 namespace Scheduler {
     auto create_scheduler(int n_workers, const std::vector<std::shared_ptr<IPollSource>>& poll_sources) -> std::unique_ptr<IScheduler>;
+    auto create_scheduler(const SchedulerConfig& config, const std::vector<std::shared_ptr<IPollSource>>& poll_sources) -> std::unique_ptr<IScheduler>;
 }
\ No newline at end of file
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <concepts>
+#include <functional>
 
 #include "scheduler/job.h"
+#include "scheduler/metrics.h"
 #include "scheduler/scheduling_context.h"
 
 // Conforming to this concept implies that some type T is indeed a scheduler and can be used as such
@@ -13,6 +15,30 @@ namespace Scheduler {
         virtual ~IScheduler() = default;
         auto virtual queue(Context ctx, Job job_fn) -> void = 0;
 
+        // queue_blocking queues a job that may block its thread for a long time, it runs on a separate pool of threads
+        // rather than on a worker. The job is invoked with an empty context so anything it queues runs on the workers
+        auto virtual queue_blocking(Job job_fn) -> void = 0;
+
+        // run_inline runs job on the calling thread's stack instead of queueing it, it only does so if the calling thread
+        // is one of the scheduler's workers (the worker identified by ctx, or any of its workers for an empty context)
+        // and the worker has not already nested too many inline jobs. It returns false if job was not run, the caller
+        // must then queue it
+        [[nodiscard]] auto virtual run_inline(Context ctx, Job& job) -> bool = 0;
+
+        // metrics takes a snapshot of the scheduler's metrics, see scheduler/metrics.h
+        [[nodiscard]] auto virtual metrics() const -> SchedulerMetrics = 0;
+
+        // concurrency is the number of workers currently running jobs, work that is split across the workers (see
+        // async_lib/parallel.h) uses it to size its initial split
+        [[nodiscard]] auto virtual concurrency() const -> unsigned int = 0;
+
+        // help_until runs other queued jobs on the calling thread until done returns true, a job that blocks on a cell
+        // hence keeps its worker busy with (likely) the very work it is waiting on instead of parking it. It returns false
+        // without running anything if the calling thread is not one of the scheduler's workers, the caller must then
+        // wait by other means. wake_helpers wakes any worker parked within help_until so it re-evaluates done
+        [[nodiscard]] auto virtual help_until(const std::function<bool()>& done) -> bool = 0;
+        auto virtual wake_helpers() -> void = 0;
+
 
         IScheduler() = default;
         IScheduler(IScheduler&&) = delete;
@@ -1,21 +1,47 @@
 #pragma once
 
+#include <cstdint>
 #include <optional>
 #include <functional>
 
 // SchedulingContext carries all information regarding the surrounding information
-// around a scheduler job, for now it just contains the worker id that the job
-// is to be run on.
+// around a scheduler job, it contains the worker id that the job is to be run on
+// and the priority the job (and any continuation queued with the context) runs at.
 namespace Scheduler {
+    // Priority classes are selected strictly, a worker only runs a Normal job once it can find no Latency job and
+    // only runs a Background job once it can find neither. Latency is intended for short jobs something is actively
+    // waiting on (timer expiries, IO completions) and Background for bulk throughput work.
+    enum class Priority : uint8_t {
+        Latency = 0,
+        Normal = 1,
+        Background = 2,
+    };
+
+    constexpr size_t num_priorities = 3;
+
     class Context {
     public:
         friend class JobScheduler;
         friend class WorkerPool;
+        friend class JobWorker;
 
         [[nodiscard]] static auto empty() -> Context { return {}; }
+        [[nodiscard]] static auto empty(Priority priority) -> Context { return Context().with_priority(priority); }
+
+        // with_priority returns a copy of this context whose jobs are queued at the given priority
+        [[nodiscard]] auto with_priority(Priority new_priority) const -> Context {
+            auto ctx = *this;
+            ctx.job_priority = new_priority;
+            return ctx;
+        }
+
+        [[nodiscard]] auto priority() const -> Priority { return job_priority; }
+
+        // worker is the id of the worker the job runs on, it is empty for jobs (and writes) from outside the workers
+        [[nodiscard]] auto worker() const -> std::optional<unsigned int> { return worker_id; }
 
         auto operator==(const Context& other) const -> bool {
-            return worker_id == other.worker_id;
+            return worker_id == other.worker_id && job_priority == other.job_priority;
         }
 
     private:
@@ -23,5 +49,6 @@ namespace Scheduler {
         Context() : worker_id(std::nullopt) {}
 
         std::optional<unsigned int> worker_id;
+        Priority job_priority = Priority::Normal;
     };
 }
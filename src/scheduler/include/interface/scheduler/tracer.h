@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Tracer is an opt-in recorder of scheduler and cell events (job execution, enqueues, steals, poll ticks and cell
+// writes/awaits) that can be written out as a Chrome trace-event JSON file and opened in ui.perfetto.dev or chrome://tracing.
+//  - Every thread records into its own lock-free single producer ring buffer, the buffer is created upon the thread's
+//    first event and outlives the thread so the events of exited workers can still be written out, it is dropped by the
+//    next start. Once a buffer is full the oldest events are overwritten
+//  - While tracing is stopped Tracer::trace is a single relaxed load and a (predicted not taken) branch
+//  - write_chrome_trace should be invoked after stop, a thread that is still recording while its buffer is being written
+//    may have its oldest events torn
+namespace Scheduler {
+    enum class TraceEvent : uint8_t {
+        JobBegin,       // arg: the priority of the job
+        JobEnd,
+        Enqueue,        // arg: the number of jobs queued
+        Steal,          // arg: the number of jobs stolen
+        PollBegin,
+        PollEnd,
+        CellWrite,      // arg: the address of the cell
+        CellAwait,      // arg: the address of the cell
+    };
+
+    class Tracer {
+    public:
+        // start begins recording (discarding anything recorded before), stop ends it
+        static auto start() -> void;
+        static auto stop() -> void;
+
+        static auto trace(TraceEvent event, uint64_t arg = 0) -> void {
+            if (enabled.load(std::memory_order_relaxed)) [[unlikely]] { record(event, arg); }
+        }
+
+        // name_thread names the calling thread in the written trace, threads that never name themselves are named by
+        // the order in which they first recorded an event
+        static auto name_thread(std::string name) -> void;
+
+        // write_chrome_trace writes every event recorded since start in the Chrome trace-event JSON format
+        static auto write_chrome_trace(std::ostream& out) -> void;
+
+    private:
+        static auto record(TraceEvent event, uint64_t arg) -> void;
+
+        inline static std::atomic<bool> enabled = { false };
+    };
+}
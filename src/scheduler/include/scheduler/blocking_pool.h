@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "scheduler/job.h"
+#include "scheduler/metrics.h"
+
+namespace Scheduler {
+    // BlockingPool runs jobs that block (fsync, name resolution, embedded databases...) away from the scheduler's
+    // workers so that a blocking job never stalls a worker. Unlike the worker pool it is a plain mutex and condition
+    // variable guarded queue: its jobs are long running, hence the cost of queueing them is irrelevant.
+    //  - Threads are spawned on demand whenever a job is queued and no thread is idle, up to max_threads
+    //  - A thread that has been idle for idle_timeout exits, the pool holds no threads while it is unused
+    //  - Jobs are invoked with an empty context, anything they queue (ie. the continuations of the cell they write)
+    //    hence lands on the worker pool's global queue and runs on the workers
+    class BlockingPool {
+    public:
+        BlockingPool(unsigned int max_threads, std::chrono::milliseconds idle_timeout);
+        ~BlockingPool();
+
+        BlockingPool(BlockingPool&&) = delete;
+        BlockingPool(const BlockingPool&) = delete;
+        auto operator=(const BlockingPool&) -> BlockingPool& = delete;
+        auto operator=(BlockingPool&&) -> BlockingPool& = delete;
+
+        auto queue(Job job) -> void;
+        [[nodiscard]] auto metrics() const -> BlockingPoolMetrics;
+
+    private:
+        using Threads = std::list<std::thread>;
+
+        // run is the loop of a single thread, self is the thread's own entry in threads which it moves over to
+        // exited_threads once it idles out, exited threads are joined by the next call to queue (or the destructor)
+        auto run(Threads::iterator self) -> void;
+        auto join_exited() -> void;
+
+        unsigned int max_threads;
+        std::chrono::milliseconds idle_timeout;
+
+        mutable std::mutex mutex;
+        std::condition_variable job_available;
+        std::deque<Job> jobs;
+        Threads threads;
+        Threads exited_threads;
+        unsigned int idle_threads = 0;
+        uint64_t jobs_run = 0;
+        bool stopping = false;
+    };
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "concurrency/spinlock.h"
+#include "scheduler/metrics.h"
+#include "scheduler/poll_source.h"
+#include "scheduler/reactor.h"
+#include "scheduler/tracer.h"
+
+namespace Scheduler {
+    using PollSource = std::shared_ptr<IPollSource>;
+    using PollSources = std::vector<PollSource>;
+
+    // PollGroup is the set of poll sources driven by a scheduler, it can be polled by any thread: by the scheduler's
+    // poll thread or opportunistically by idle workers. Only a single thread polls the group at a time, the group is
+    // guarded by a try-lock and a thread that finds another already polling simply moves on.
+    //  - A source's due time only ever moves earlier until it is polled (sources such as IO report a deadline relative
+    //    to now that would otherwise be pushed back on every poll), once polled it is reset to its fresh next_poll
+    //  - The group is the waker of its sources, a source handed new work wakes the group's reactor which marks the group
+    //    as needing a poll (its due times must be gathered again) and interrupts the poll thread's wait
+    class PollGroup {
+    public:
+        using TimePoint = IPollSource::TimePoint;
+
+        explicit PollGroup(PollSources poll_sources);
+        ~PollGroup();
+
+        PollGroup(PollGroup&&) = delete;
+        PollGroup(const PollGroup&) = delete;
+        auto operator=(const PollGroup&) -> PollGroup& = delete;
+        auto operator=(PollGroup&&) -> PollGroup& = delete;
+
+        // try_poll polls every due source handing each source's jobs to queue_jobs, it returns false if another
+        // thread was already polling the group
+        template <typename QueueJobs>
+        auto try_poll(QueueJobs&& queue_jobs) -> bool;
+
+        // needs_poll is a cheap check of whether a source has come due (or woken the group) since the group was last polled
+        [[nodiscard]] auto needs_poll(TimePoint now) const -> bool;
+
+        // wait blocks the calling thread until the group needs polling, it is only invoked by the poll thread
+        auto wait() -> void { reactor.wait_until(deadline()); }
+        auto wait_until(TimePoint time) -> void { reactor.wait_until(time); }
+        auto wake() -> void { reactor.wake(); }
+
+        // metrics takes a snapshot of the number of polls and the poll durations of each source
+        [[nodiscard]] auto metrics() const -> std::vector<PollSourceMetrics>;
+
+    private:
+        // PollCounters are written by whichever thread holds the group, the try-lock serialises their writers
+        struct PollCounters {
+            Counter polls;
+            Histogram poll_duration;
+        };
+
+        [[nodiscard]] auto deadline() const -> std::optional<TimePoint>;
+        [[nodiscard]] static auto earliest(std::optional<TimePoint> lhs, std::optional<TimePoint> rhs) -> std::optional<TimePoint>;
+
+        constexpr static int64_t never = std::numeric_limits<int64_t>::max();
+
+        Reactor reactor;
+        SpinLock polling;
+        PollSources poll_sources;
+        std::vector<std::optional<TimePoint>> due;
+        std::vector<PollCounters> poll_counters;
+
+        // next_due is the earliest due time of any source (in steady clock ticks), it is written by the polling thread
+        // and read by idle workers deciding whether to poll
+        std::atomic<int64_t> next_due = { 0 };
+    };
+}
+
+
+
+
+
+
+
+// Implementation
+template <typename QueueJobs>
+auto Scheduler::PollGroup::try_poll(QueueJobs&& queue_jobs) -> bool {
+    if (!polling.try_lock()) { return false; }
+    const auto lock = std::lock_guard<SpinLock>(polling, std::adopt_lock);
+
+    // wakes are cleared before due times are gathered, a source that is handed new work while they are being gathered
+    // wakes the group again and the group is simply polled again
+    reactor.clear_wake();
+    Tracer::trace(TraceEvent::PollBegin);
+
+    auto now = std::chrono::steady_clock::now();
+    auto group_deadline = std::optional<TimePoint>();
+    for (size_t i = 0; i < poll_sources.size(); i++) {
+        due[i] = earliest(due[i], poll_sources[i]->next_poll());
+        if (due[i].has_value() && due[i].value() <= now) {
+            auto poll_started = metrics_enabled ? std::chrono::steady_clock::now() : TimePoint();
+            auto jobs = poll_sources[i]->poll();
+            if constexpr (metrics_enabled) {
+                auto poll_duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - poll_started);
+                poll_counters[i].polls.increment();
+                poll_counters[i].poll_duration.record(static_cast<uint64_t>(poll_duration.count()));
+            }
+
+            queue_jobs(std::move(jobs));
+            due[i] = poll_sources[i]->next_poll();
+        }
+
+        group_deadline = earliest(group_deadline, due[i]);
+    }
+
+    next_due.store(group_deadline.has_value() ? group_deadline->time_since_epoch().count() : never, std::memory_order_release);
+    Tracer::trace(TraceEvent::PollEnd);
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <chrono>
+
+#include "scheduler/poll_source.h"
+
+namespace Scheduler {
+    // Reactor is the blocking core of the scheduler's poll thread, the poll thread sleeps in epoll_wait on two descriptors:
+    //  - a timerfd armed for the earliest deadline any poll source reported via next_poll
+    //  - an eventfd that poll sources signal (through IPollWaker::wake) when new work may have moved their deadline earlier
+    // hence the poll thread consumes no cpu while there are neither due timers nor in-flight work. Wakes are coalesced,
+    // only the first wake after the poll thread last cleared them performs a syscall.
+    class Reactor : public IPollWaker {
+    public:
+        using TimePoint = IPollSource::TimePoint;
+
+        Reactor();
+        ~Reactor() override;
+
+        Reactor(Reactor&&) = delete;
+        Reactor(const Reactor&) = delete;
+        auto operator=(const Reactor&) -> Reactor& = delete;
+        auto operator=(Reactor&&) -> Reactor& = delete;
+
+        auto wake() -> void override;
+
+        // clear_wake must be invoked before the poll thread gathers deadlines from its sources, any wake after this point
+        // interrupts the next wait_until
+        auto clear_wake() -> void;
+        [[nodiscard]] auto is_woken() const -> bool { return wake_pending.load(std::memory_order_acquire); }
+
+        // wait_until blocks until the deadline passes (indefinitely for std::nullopt) or the reactor is woken, it returns
+        // straight away while a wake is pending (one that has not been cleared by a poll)
+        auto wait_until(std::optional<TimePoint> deadline) -> void;
+
+    private:
+        auto arm_timer(std::optional<TimePoint> deadline) -> void;
+
+        int epoll_fd;
+        int timer_fd;
+        int wake_fd;
+        std::atomic<bool> wake_pending = { false };
+    };
+}
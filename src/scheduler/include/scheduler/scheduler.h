@@ -1,36 +1,57 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <thread>
 #include <optional>
 
 #include "scheduler/scheduler_intf.h"
 #include "scheduler/poll_source.h"
+#include "scheduler/blocking_pool.h"
+#include "scheduler/poll_group.h"
+#include "scheduler/scheduler_config.h"
 #include "scheduler/worker_pool.h"
 #include "scheduler/scheduling_context.h"
 
 namespace Scheduler {
-    using PollSource = std::shared_ptr<IPollSource>;
-    using PollSources = std::vector<PollSource>;
-    
     // The core Scheduler is a work stealing scheduler based on a sequence of worker pools. Worker's are responsible for
     // executing work and all continuations are scheduled on the queue for that worker that just executed the job.
     // Workers that run out of work can evict work from other workers. Alongside this the scheduler also has a poll thread
     // this poll thread is responsible for polling a set of poll sources and queueing the jobs returned by the poll sources.
+    // The poll thread is driven by a Reactor, it sleeps until the earliest deadline of its poll sources or until a poll source wakes it.
+    // With idle_worker_polling the poll sources are primarily polled by idle workers, see SchedulerConfig.
     // Poll sources can do a variety of things... poll timers, poll asynchronous IO, etc. Essentially anything that doesn't directly
     // fit into the continuation model for Async can be implemented via a poll source.
     class Scheduler : public IScheduler {
     public:
-        Scheduler(unsigned int n_workers, const PollSources& poll_sources);            
+        Scheduler(unsigned int n_workers, const PollSources& poll_sources);
+        Scheduler(const SchedulerConfig& config, const PollSources& poll_sources);
 
         // queue will queue a job to be executed by the scheduler
         auto queue(Context ctx, std::vector<Job> jobs) -> void;
         auto queue(Context ctx, Job job_fn) -> void override;
+        auto queue_blocking(Job job_fn) -> void override;
+        [[nodiscard]] auto run_inline(Context ctx, Job& job) -> bool override;
+
+        // worker_stats exposes the steal counters of each worker in the scheduler's pool
+        [[nodiscard]] auto worker_stats() const -> std::vector<WorkerStats>;
+        [[nodiscard]] auto metrics() const -> SchedulerMetrics override;
+        [[nodiscard]] auto concurrency() const -> unsigned int override;
+        [[nodiscard]] auto help_until(const std::function<bool()>& done) -> bool override;
+        auto wake_helpers() -> void override;
 
     private:
-        auto begin_poll(const std::stop_token& stop_token, PollSources poll_sources) -> void;
+        auto begin_poll(const std::stop_token& stop_token) -> void;
+
+        // the time the poll thread leaves a due poll group to searching workers before polling it itself
+        constexpr static std::chrono::microseconds idle_poll_grace = std::chrono::microseconds(200);
 
+        // the poll group must outlive the workers and the poll thread that poll it
+        PollGroup poll_group;
         WorkerPool worker_pool;
+        // blocking jobs queue their continuations onto the worker pool, hence the blocking pool is stopped first
+        BlockingPool blocking_pool;
         std::jthread poll_thread;
     };
 }
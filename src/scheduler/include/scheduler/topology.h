@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Topology describes the layout of the logical CPUs of the machine, it is used to pin workers to CPUs and to order the
+// victims a worker steals from so that work preferentially moves between workers that share caches.
+// A topology is either discovered from sysfs (/sys/devices/system/cpu) or loaded from a simulated topology file, this
+// allows the topology aware paths of the scheduler to be exercised on machines that don't have the topology being tested.
+// A simulated topology file holds a line per logical CPU containing four whitespace separated ids:
+//      # cpu core llc node
+//      0 0 0 0
+//      1 0 0 0
+//      2 1 0 0
+// core ids are global (CPUs that share a core are SMT siblings), lines beginning with # are ignored.
+namespace Scheduler {
+    struct Cpu {
+        unsigned int id;
+        unsigned int core;
+        unsigned int llc;
+        unsigned int node;
+    };
+
+    // StealTier orders victims by how close they are to the thief, thieves exhaust a tier before moving onto the next
+    enum class StealTier : size_t {
+        SmtSibling = 0,     // shares a physical core with the thief
+        SameNode = 1,       // shares the last level cache or NUMA node with the thief
+        Remote = 2,         // everything else
+    };
+
+    constexpr size_t num_steal_tiers = 3;
+
+    class Topology {
+    public:
+        // discover only includes the cpus the process may run on (see can_pin), a process restricted by taskset or a
+        // cgroup cpuset has its workers placed on its own cpus rather than on the first cpus of the machine
+        [[nodiscard]] static auto discover(const std::string& sysfs_cpu_root = "/sys/devices/system/cpu") -> std::optional<Topology>;
+        [[nodiscard]] static auto from_file(const std::string& path) -> std::optional<Topology>;
+
+        // can_pin indicates whether a thread of the process can be pinned to cpu, ie. cpu is in the process's affinity mask
+        [[nodiscard]] static auto can_pin(unsigned int cpu) -> bool;
+
+        // cpus returns the logical cpus ordered such that CPUs sharing a node, cache and core are adjacent, assigning
+        // workers to CPUs in this order packs workers that share work onto the same caches
+        [[nodiscard]] auto cpus() const -> const std::vector<Cpu>& { return ordered_cpus; }
+        [[nodiscard]] static auto tier(const Cpu& thief, const Cpu& victim) -> StealTier;
+
+    private:
+        explicit Topology(std::vector<Cpu> cpus);
+
+        std::vector<Cpu> ordered_cpus;
+    };
+}
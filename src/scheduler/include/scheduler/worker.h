@@ -1,33 +1,200 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <span>
 #include <thread>
+#include <stop_token>
+#include <vector>
 
-#include "scheduler/job_queue.h"
+#include "concurrency/cache_line.h"
+#include "concurrency/segmented_queue.h"
+#include "concurrency/slab_allocator.h"
+#include "concurrency/work_stealing_deque.h"
 #include "scheduler/job.h"
+#include "scheduler/metrics.h"
+#include "scheduler/topology.h"
 
 namespace Scheduler {
-    using StealWork = std::function<std::optional<Job>()>;
+    class WorkerPool;
+
+    // WorkerStats are the counters a worker keeps about its stealing, steals is the number of successful steal
+    // operations and stolen_jobs the total number of jobs those steals moved onto the worker's queue, steals_by_tier
+    // breaks steals down by how close the victim was to the thief (indexed by StealTier)
+    struct WorkerStats {
+        uint64_t steals;
+        uint64_t stolen_jobs;
+        std::array<uint64_t, num_steal_tiers> steals_by_tier;
+    };
+
+    // WorkerCounters are the metrics a worker records beyond its WorkerStats, each counter has a single writer: the
+    // worker's own thread (queue_latency is recorded by jobs as they start on the worker). The counters of different
+    // workers are kept on different cache lines
+    struct alignas(cache_line_size) WorkerCounters {
+        Counter jobs_run;
+        Counter failed_steals;
+        Counter parks;
+        Histogram queue_latency;
+    };
 
     // JobWorkers are responsible for executing jobs. Whenever the worker is out of work
-    // it can choose to steal a job from another worker using the handle provided by the WorkerPool
+    // it can choose to steal a job from another worker via the WorkerPool that owns it, if no work can be found
+    // the worker spins briefly, then yields and finally parks itself until the pool is handed new work.
+    // Workers hold a queue per priority class, see Scheduler::Priority for how jobs are selected between them.
     class JobWorker {
     public:
-        JobWorker(Context worker_context, StealWork steal_work);
+        // a worker given a cpu pins its thread to that cpu once started, its queues are allocated from the pinned
+        // thread so they are first touched (and hence placed) on the cpu's NUMA node
+        JobWorker(Context worker_context, WorkerPool& pool, std::optional<unsigned int> cpu = std::nullopt);
 
         // start begins the individual worker on a new thread, it's worth noting that this is slightly different from the rest of the codebase
         // this is because we want to be able to create all the workers beforehand (specifically their worker queues) and then start them
         // once they've all been created. The reason we do this is to prevent a situation where a worker is started and then immediately
         // attempts to steal work from a worker that hasn't been created yet.
+        // A worker that has retired (see WorkerPool::park) can be started again, its previous thread is joined first
         [[nodiscard]] auto start() -> bool;
-        [[nodiscard]] auto steal_job() -> std::optional<Job>;
+        [[nodiscard]] auto is_running() const -> bool { return running.load(std::memory_order_acquire); }
+        [[nodiscard]] auto steal_job(Priority priority) -> std::optional<Job>;
+
+        // steal_half steals up to half of this worker's queue of the given priority on behalf of the thief, the first
+        // stolen job is returned and the remainder are pushed onto the thief's queue, this must be invoked from the thief's thread
+        [[nodiscard]] auto steal_half(JobWorker& thief, Priority priority, StealTier tier) -> std::optional<Job>;
+
+        // add_victim/victims maintain the workers this worker steals from grouped by tier, victims must be added before
+        // the worker is started
+        auto add_victim(StealTier tier, JobWorker& victim) -> void;
+        [[nodiscard]] auto victims(StealTier tier) const -> std::span<JobWorker* const>;
+
+        // next_random is a cheap xorshift generator used for victim selection, it may only be invoked from the worker's thread
+        [[nodiscard]] auto next_random() -> uint32_t;
+        [[nodiscard]] auto stats() const -> WorkerStats;
+        [[nodiscard]] auto counters() -> WorkerCounters& { return worker_counters; }
+
+        // metrics takes a snapshot of the worker's queue depths, stats and counters
+        [[nodiscard]] auto metrics() const -> WorkerMetrics;
+
+        // request_stop signals the worker thread to stop and join waits for it to exit, they are distinct as
+        // a pool must stop ALL of its workers before it joins any of them, otherwise a running worker may
+        // attempt to steal from a worker that has already been destroyed
+        auto request_stop() -> void;
+        auto join() -> void;
+
+        // is_current_thread indicates if the calling thread is this worker's thread, the worker's queue is a
+        // Chase-Lev deque hence only the worker's own thread may queue jobs onto it
+        [[nodiscard]] auto is_current_thread() const -> bool;
+
+        // current returns the worker that owns the calling thread, nullptr if the calling thread is not a worker
+        [[nodiscard]] static auto current() -> JobWorker*;
+        [[nodiscard]] auto owner() const -> const WorkerPool& { return pool.get(); }
+        [[nodiscard]] auto context() const -> Context { return worker_context; }
+
+        // help_until runs jobs from the worker's thread until done returns true, it is invoked from within a job that
+        // blocks and idles the same way as run except that it parks via WorkerPool::park_helper
+        auto help_until(const std::function<bool()>& done) -> void;
+
+        // queue pushes jobs onto the bottom of the worker's deque, this may only be invoked from the worker's own thread
+        // the span overload moves every job out of jobs and publishes them with a single update of the deque
+        auto queue(Priority priority, std::span<Job> jobs) -> void;
+        auto queue(Priority priority, Job job) -> void;
+
+        // push_lifo places a job into the worker's LIFO slot, the job previously in the slot is moved onto the worker's
+        // deque. The slot is checked before the deque of its priority so the job most recently queued by a running job
+        // (usually its continuation) runs next, while its inputs are still in cache. Thieves only take the slot once
+        // the job has sat in it for lifo_grace, hence a worker that is briefly busy doesn't have its continuation migrated.
+        // At most lifo_budget jobs run from the slot in a row, the worker then spills the slot onto its deque and runs
+        // the oldest job of its deque. Returns true if a job was placed on the deque (ie. there is work for other workers).
+        // This may only be invoked from the worker's own thread
+        [[nodiscard]] auto push_lifo(Priority priority, Job job) -> bool;
+
+        // inject pushes jobs onto the worker's inject queue, unlike queue it may be invoked from any thread. This is how
+        // a job is handed to a worker other than the calling one (ie. a coroutine resumed by another thread), the worker
+        // takes its injected jobs once its own deque is empty and thieves take them once the worker's deque and LIFO slot
+        // are empty. Jobs injected into a worker that has stopped running are moved onto the pool's global queue
+        auto inject(Priority priority, Job job) -> void;
+        auto inject(Priority priority, std::span<Job> jobs) -> void;
+
+        // queue_size is the total size of the worker's queues (and LIFO slot) across every priority
+        // Note: the size of the queue is only approximate when observed from another thread
+        [[nodiscard]] auto queue_size() const -> size_t;
 
-        auto queue(std::vector<Job> jobs) -> void;
-        auto queue(Job job) -> void;
     private:
+        using JobQueue = WorkStealingDeque<Job, SlabAllocator<Job>>;
+
+        auto run(const std::stop_token& stop_token) -> void;
+        auto run_job(Job& job, Priority priority) -> void;
+
+        // next_job finds the next job to run writing its priority to priority, it checks the local and then the
+        // global queue of each priority in turn (highest first), only once all of those are empty does it steal.
+        // A worker whose jobs keep queueing more local work would otherwise never look past its own queues, hence every
+        // global_check_interval jobs it checks the global queues (and any due poll sources) first, see check_global
+        [[nodiscard]] auto next_job(Priority& priority) -> std::optional<Job>;
+        [[nodiscard]] auto check_global(Priority& priority) -> std::optional<Job>;
+        [[nodiscard]] auto job_queue(Priority priority) -> JobQueue& { return job_queues.at(static_cast<size_t>(priority)); }
+        [[nodiscard]] auto inject_queue(Priority priority) -> SegmentedQueue<Job>& { return inject_queues.at(static_cast<size_t>(priority)); }
+
+        // take_injected takes up to max_inject_batch injected jobs, the first is returned and the rest are placed on the
+        // worker's deque. release_injected moves every injected job onto the pool's global queue, it is invoked by the
+        // worker as it stops running and by an injecting thread that finds the worker no longer running, whichever of
+        // the two comes second is guaranteed to observe the other (both sides are sequentially consistent)
+        [[nodiscard]] auto take_injected(Priority priority) -> std::optional<Job>;
+        auto release_injected() -> void;
+
+        // take_lifo takes the job in the LIFO slot if it is of the given priority, once the slot has run lifo_budget
+        // jobs in a row it instead spills the slot and sets spilled so that next_job runs the oldest job of the deque
+        [[nodiscard]] auto take_lifo(Priority priority, bool& spilled) -> std::optional<Job>;
+        [[nodiscard]] auto steal_lifo(Priority priority) -> std::optional<Job>;
+        [[nodiscard]] auto claim_lifo(Priority priority) -> std::optional<Job>;
+
+        // the number of idle rounds a worker spins for (and then yields for) before finally parking
+        constexpr static unsigned int idle_spin_rounds = 64;
+        constexpr static unsigned int idle_yield_rounds = 16;
+
+        // queues are constructed with a minimal ring buffer and grown to queue_capacity by the worker's own thread
+        constexpr static size_t queue_capacity = 1024;
+        constexpr static size_t max_inject_batch = 32;
+
+        constexpr static unsigned int lifo_budget = 16;
+        constexpr static std::chrono::microseconds lifo_grace = std::chrono::microseconds(50);
+
+        // prime so that the check doesn't fall into step with the LIFO slot's budget
+        constexpr static unsigned int global_check_interval = 61;
+
+        // the slot is Full while it holds a job and Claimed while a thread (the owner or a thief) is moving the job out
+        enum class SlotState : uint8_t {
+            Empty,
+            Full,
+            Claimed,
+        };
+
+        // pin_to_cpu restricts the calling thread to the worker's cpu (if it has one), failure is ignored
+        auto pin_to_cpu() const -> void;
+
         Context worker_context;
-        StealWork steal_work;
-        JobQueue job_queue;
+        std::reference_wrapper<WorkerPool> pool;
+        std::optional<unsigned int> cpu;
+        // job boxes are allocated from the worker's slab arena, stolen jobs are freed back to it remotely
+        std::array<JobQueue, num_priorities> job_queues = { JobQueue(1), JobQueue(1), JobQueue(1) };
+        std::array<SegmentedQueue<Job>, num_priorities> inject_queues;
+        std::array<std::vector<JobWorker*>, num_steal_tiers> victim_tiers;
         std::optional<std::jthread> worker_thread;
+        std::atomic<bool> running = { false };
+
+        // the LIFO slot, lifo_job is only accessed by the thread that filled or claimed the slot
+        std::optional<Job> lifo_job;
+        std::atomic<SlotState> lifo_state = { SlotState::Empty };
+        std::atomic<Priority> lifo_priority = { Priority::Normal };
+        std::atomic<std::chrono::steady_clock::rep> lifo_filled_at = { 0 };
+        unsigned int lifo_streak = 0;
+        unsigned int jobs_since_global_check = 0;
+
+        uint32_t rng_state;
+        std::atomic<uint64_t> steals = { 0 };
+        std::atomic<uint64_t> stolen_jobs = { 0 };
+        std::array<std::atomic<uint64_t>, num_steal_tiers> tier_steals = {};
+        WorkerCounters worker_counters;
     };
-}
\ No newline at end of file
+}
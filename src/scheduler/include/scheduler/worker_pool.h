@@ -1,9 +1,23 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
 
-#include "scheduler/job_queue.h"
+#include "concurrency/event_count.h"
+#include "concurrency/segmented_queue.h"
 #include "scheduler/job.h"
+#include "scheduler/metrics.h"
+#include "scheduler/poll_group.h"
+#include "scheduler/scheduler_config.h"
+#include "scheduler/topology.h"
 #include "scheduler/worker.h"
 #include "scheduler/scheduling_context.h"
 
@@ -12,17 +26,143 @@ namespace Scheduler {
     public:
         explicit WorkerPool(unsigned int n_workers);
 
+        // a pool configured to pin its workers assigns worker i to the i-th cpu of the topology (wrapping around when
+        // there are more workers than cpus), as the topology orders cpus by node, cache and core neighbouring workers
+        // share the most hardware. Victims are grouped by their steal tier relative to each thief
+        // a pool handed a poll group polls it from workers that are searching for work, see SchedulerConfig::idle_worker_polling
+        // an elastic pool (see SchedulerConfig::max_workers) creates a worker for every slot up front and only starts
+        // n_workers of them, a supervisor thread starts the remaining slots while the pool is saturated. Slots are never
+        // destroyed so the victim lists of each worker remain valid as workers come and go
+        explicit WorkerPool(const SchedulerConfig& config, PollGroup* poll_group = nullptr);
+        ~WorkerPool();
+
+        WorkerPool(WorkerPool&&) = delete;
+        WorkerPool(const WorkerPool&) = delete;
+        auto operator=(const WorkerPool&) -> WorkerPool& = delete;
+        auto operator=(WorkerPool&&) -> WorkerPool& = delete;
+
+        // queue pushes jobs onto the queue of the worker specified by the context, jobs can only be pushed directly onto
+        // a worker's queue from that worker's own thread. From any other thread the jobs are injected into the worker's
+        // inject queue (see JobWorker::inject), jobs whose context names no running worker are placed on the global queue.
+        // Jobs queued with an empty context from one of the pool's workers (ie. tasks created within a job) are placed
+        // on that worker's queue, a worker blocked on such a task then runs it depth first (see help_until). A single job
+        // queued onto a worker goes into the worker's LIFO slot (see JobWorker::push_lifo) unless SchedulerConfig::lifo_slot
+        // is disabled. A batch of jobs is published to the queue in bulk and wakes up to one parked worker per job,
+        // queueing a single job performs no allocation beyond the queue's own storage
         auto queue(Context ctx, Job job) -> void;
         auto queue(Context ctx, std::vector<Job> jobs) -> void;
 
+        // run_inline runs job on the calling worker's stack if the calling thread is the worker local to ctx (see
+        // local_worker) and fewer than max_inline_depth inline jobs are running beneath it, the job is handed the worker's
+        // context at the priority of ctx. Returns false if the job was not run
+        [[nodiscard]] auto run_inline(Context ctx, Job& job) -> bool;
+
+        // worker_stats returns a snapshot of each worker's steal counters, indexed by worker id
+        [[nodiscard]] auto worker_stats() const -> std::vector<WorkerStats>;
+
+        // metrics takes a snapshot of each worker's metrics and the depth of the global queues, the poll source metrics
+        // are left empty for the owner of the poll group to fill in
+        [[nodiscard]] auto metrics() const -> SchedulerMetrics;
+
+        // has_idle_pollers indicates whether some worker is searching for work and will hence poll the pool's poll group
+        [[nodiscard]] auto has_idle_pollers() const -> bool;
+
+        // help_until runs jobs on the calling worker until done returns true, it returns false if the calling thread
+        // is not one of the pool's workers. A helper that finds no work parks alongside the idle workers, it is woken by
+        // newly queued work or by wake_helpers, see IScheduler::help_until
+        [[nodiscard]] auto help_until(const std::function<bool()>& done) -> bool;
+        auto wake_helpers() -> void;
+
+        // active_workers is the number of workers currently running, it is only approximate for elastic pools
+        [[nodiscard]] auto active_workers() const -> unsigned int { return running_workers.load(std::memory_order_relaxed); }
+
     private:
-        // find_new_work attempts to find a new job to work on, if no job is found it returns std::nullopt
-        // this method is specifically used by Workers when they wish to find new work, it randomly evicts jobs
-        // from an arbitrary worker's queue and returns it to the caller, however it first checks that nothing is
-        // in the global queue before attempting to steal work from another worker
-        [[nodiscard]] auto find_new_work() -> std::optional<Job>;
-
-        JobQueue global_queue;
-        std::vector<JobWorker> workers;
+        // JobWorkers call back into their pool when they run out of local work
+        friend class JobWorker;
+
+        // take_global takes a fair share of the global queue of the given priority (at most max_global_batch jobs), the
+        // first job is returned and the surplus of the batch is placed on the thief's own queue
+        [[nodiscard]] auto take_global(JobWorker& thief, Priority priority) -> std::optional<Job>;
+
+        // steal_work steals half of the queue of the given priority of a randomly chosen worker, victims are tried tier by tier
+        // so a thief only steals from a remote worker once its SMT siblings and same node workers have nothing to steal.
+        // If no job is found it returns std::nullopt
+        [[nodiscard]] auto steal_work(JobWorker& thief, Priority priority) -> std::optional<Job>;
+
+        // start_searching/stop_searching track the number of workers that are actively spinning for work, while a worker
+        // is searching there is no need to wake a parked worker for newly queued work as the searcher will pick it up.
+        // When the last searcher finds work it wakes one parked worker, that worker then becomes the new searcher, this
+        // ramps the pool up one worker at a time rather than waking every worker on every queued job
+        auto start_searching() -> void;
+        auto stop_searching(bool found_work) -> void;
+
+        // park blocks the worker until new work is queued or the worker is requested to stop, the worker re-checks every
+        // queue after registering as a waiter so a job queued concurrently with parking can never be missed.
+        // In an elastic pool a worker parked for idle_worker_timeout is retired (unless that would leave fewer than
+        // n_workers running), park then returns false and the worker must exit
+        [[nodiscard]] auto park(JobWorker& worker, const std::stop_token& stop_token) -> bool;
+        [[nodiscard]] auto try_retire(const JobWorker& worker) -> bool;
+
+        // park_helper parks a worker within help_until, the worker re-checks done after registering as a waiter so a
+        // wake_helpers issued concurrently with parking can never be missed
+        auto park_helper(JobWorker& worker, const std::function<bool()>& done) -> void;
+
+        // supervise is the supervisor thread of an elastic pool, it sleeps until the pool reports pressure (or for at
+        // most supervise_interval) and starts a worker while the pool remains saturated, see SchedulerConfig::max_workers
+        auto supervise(const std::stop_token& stop_token) -> void;
+        auto start_worker() -> void;
+        [[nodiscard]] auto is_elastic() const -> bool { return workers.size() > min_workers; }
+        [[nodiscard]] auto is_saturated() const -> bool;
+        [[nodiscard]] auto pending_jobs() const -> size_t;
+
+        // notify_workers wakes up to n parked workers for n newly queued jobs, less the number of workers already searching
+        auto notify_workers(size_t n) -> void;
+
+        // poll_idle polls the pool's poll group on behalf of an idle worker if any of its sources are due, the resulting
+        // jobs are queued onto the worker's own queue (identified by ctx) as Latency jobs
+        auto poll_idle(Context ctx) -> void;
+        [[nodiscard]] auto has_work(const JobWorker& worker) const -> bool;
+
+        // local_worker returns the worker identified by ctx if the calling thread is that worker's thread, for an empty
+        // context it returns the calling thread's worker if it belongs to this pool
+        [[nodiscard]] auto local_worker(Context ctx) const -> JobWorker*;
+
+        // named_worker returns the worker identified by ctx if it is running, regardless of the calling thread
+        [[nodiscard]] auto named_worker(Context ctx) const -> JobWorker*;
+        [[nodiscard]] auto global_queue(Priority priority) -> SegmentedQueue<Job>& { return global_queues.at(static_cast<size_t>(priority)); }
+
+        // load_topology returns the topology the pool's workers are placed on, std::nullopt if workers are not pinned
+        [[nodiscard]] static auto load_topology(const SchedulerConfig& config) -> std::optional<Topology>;
+
+        // sample_queue_latency wraps one in every queue_latency_sample_period jobs queued by the calling thread such that
+        // the job records its queue-to-start latency into the worker that ends up running it
+        auto sample_queue_latency(Job& job) -> void;
+
+        // the maximum number of jobs a worker will take from the global queue at once
+        constexpr static size_t max_global_batch = 32;
+        constexpr static uint32_t queue_latency_sample_period = 64;
+        // each inline job holds a handful of frames (the job, the cell write and the dispatch of its continuations)
+        constexpr static unsigned int max_inline_depth = 32;
+        // the supervisor re-checks the pool at least this often, this catches saturation that no queue call reports
+        // (ie. every running worker blocking on a task whose job is already queued)
+        constexpr static std::chrono::milliseconds supervise_interval = std::chrono::milliseconds(10);
+
+        std::array<SegmentedQueue<Job>, num_priorities> global_queues;
+        PollGroup* poll_group;
+        bool lifo_slot;
+        EventCount idle_workers;
+        std::atomic<size_t> searching_workers = { 0 };
+        // workers are heap allocated as their deques are not movable, this also guarantees each worker
+        // has a stable address for the lifetime of its thread
+        std::vector<std::unique_ptr<JobWorker>> workers;
+
+        // elastic pool state, see SchedulerConfig::max_workers
+        unsigned int min_workers;
+        std::chrono::microseconds grow_after;
+        size_t grow_queue_depth;
+        std::chrono::milliseconds idle_worker_timeout;
+        std::atomic<unsigned int> running_workers = { 0 };
+        EventCount pressure;
+        std::optional<std::jthread> supervisor;
     };
 }
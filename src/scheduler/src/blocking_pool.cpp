@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "scheduler/blocking_pool.h"
+#include "scheduler/job.h"
+#include "scheduler/metrics.h"
+#include "scheduler/scheduling_context.h"
+
+Scheduler::BlockingPool::BlockingPool(unsigned int max_threads, std::chrono::milliseconds idle_timeout) :
+    max_threads(std::max(max_threads, 1u)),
+    idle_timeout(idle_timeout) {}
+
+Scheduler::BlockingPool::~BlockingPool() {
+    {
+        const std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    // once stopping is set threads no longer move themselves between the lists
+    job_available.notify_all();
+    for (auto& thread : threads) { thread.join(); }
+    for (auto& thread : exited_threads) { thread.join(); }
+}
+
+auto Scheduler::BlockingPool::queue(Job job) -> void {
+    join_exited();
+
+    auto lock = std::unique_lock(mutex);
+    jobs.push_back(std::move(job));
+    if (jobs.size() > idle_threads && threads.size() < max_threads) {
+        // the thread is only handed its own position in the list once it exists, it cannot run until we release the lock
+        auto self = threads.emplace(threads.end());
+        *self = std::thread([this, self]() { run(self); });
+        return;
+    }
+
+    lock.unlock();
+    job_available.notify_one();
+}
+
+auto Scheduler::BlockingPool::run(Threads::iterator self) -> void {
+    auto lock = std::unique_lock(mutex);
+    while (!stopping) {
+        if (!jobs.empty()) {
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+
+            lock.unlock();
+            job(Context::empty());
+            lock.lock();
+
+            jobs_run += 1;
+            continue;
+        }
+
+        idle_threads += 1;
+        auto woken = job_available.wait_for(lock, idle_timeout, [this]() { return stopping || !jobs.empty(); });
+        idle_threads -= 1;
+
+        if (!woken) {
+            exited_threads.splice(exited_threads.end(), threads, self);
+            return;
+        }
+    }
+}
+
+auto Scheduler::BlockingPool::join_exited() -> void {
+    auto exited = Threads();
+    {
+        const std::lock_guard lock(mutex);
+        if (exited_threads.empty()) { return; }
+        exited.swap(exited_threads);
+    }
+
+    for (auto& thread : exited) { thread.join(); }
+}
+
+auto Scheduler::BlockingPool::metrics() const -> BlockingPoolMetrics {
+    const std::lock_guard lock(mutex);
+    return BlockingPoolMetrics {
+        .threads = threads.size(),
+        .idle_threads = idle_threads,
+        .queue_depth = jobs.size(),
+        .jobs_run = jobs_run,
+    };
+}
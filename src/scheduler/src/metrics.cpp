@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "scheduler/metrics.h"
+
+namespace {
+    constexpr auto priority_names = std::array { "latency", "normal", "background" };
+    constexpr auto reported_quantiles = std::array { 0.5, 0.9, 0.99, 0.999 };
+    constexpr double nanoseconds_per_second = 1e9;
+
+    auto write_header(std::ostringstream& out, const char* name, const char* help, const char* type) -> void {
+        out << "# HELP " << name << ' ' << help << '\n';
+        out << "# TYPE " << name << ' ' << type << '\n';
+    }
+
+    // write_summary writes a histogram of nanosecond durations as a Prometheus summary in seconds
+    auto write_summary(std::ostringstream& out, const char* name, const std::string& labels, const Scheduler::HistogramSnapshot& histogram) -> void {
+        auto separator = labels.empty() ? "" : ",";
+        for (auto quantile : reported_quantiles) {
+            auto value = static_cast<double>(histogram.percentile(quantile)) / nanoseconds_per_second;
+            out << name << '{' << labels << separator << "quantile=\"" << quantile << "\"} " << value << '\n';
+        }
+
+        auto label_set = labels.empty() ? std::string() : '{' + labels + '}';
+        out << name << "_sum" << label_set << ' ' << static_cast<double>(histogram.sum) / nanoseconds_per_second << '\n';
+        out << name << "_count" << label_set << ' ' << histogram.count() << '\n';
+    }
+}
+
+// bucket_of maps values below sub_buckets onto themselves, larger values land in the linear sub bucket of their power of
+// two range. For a value with its highest set bit at position e the sub bucket is given by the sub_bucket_bits below that bit
+auto Scheduler::HistogramSnapshot::bucket_of(uint64_t value) -> size_t {
+    value = std::min(value, (uint64_t(1) << max_value_bits) - 1);
+    if (value < sub_buckets) { return static_cast<size_t>(value); }
+
+    auto exponent = static_cast<size_t>(std::bit_width(value)) - 1;
+    auto sub_bucket = static_cast<size_t>(value >> (exponent - sub_bucket_bits)) & (sub_buckets - 1);
+    return (exponent - sub_bucket_bits + 1) * sub_buckets + sub_bucket;
+}
+
+auto Scheduler::HistogramSnapshot::highest_value_in(size_t bucket) -> uint64_t {
+    if (bucket < sub_buckets) { return bucket; }
+
+    auto exponent = bucket / sub_buckets + sub_bucket_bits - 1;
+    auto sub_bucket = bucket % sub_buckets;
+    auto lowest_value = (uint64_t(sub_buckets + sub_bucket)) << (exponent - sub_bucket_bits);
+    return lowest_value + (uint64_t(1) << (exponent - sub_bucket_bits)) - 1;
+}
+
+auto Scheduler::HistogramSnapshot::merge(const HistogramSnapshot& other) -> void {
+    for (size_t bucket = 0; bucket < num_buckets; bucket++) { counts.at(bucket) += other.counts.at(bucket); }
+    sum += other.sum;
+}
+
+auto Scheduler::HistogramSnapshot::count() const -> uint64_t {
+    auto total = uint64_t(0);
+    for (auto bucket_count : counts) { total += bucket_count; }
+    return total;
+}
+
+auto Scheduler::HistogramSnapshot::mean() const -> double {
+    auto total = count();
+    return total == 0 ? 0.0 : static_cast<double>(sum) / static_cast<double>(total);
+}
+
+auto Scheduler::HistogramSnapshot::percentile(double fraction) const -> uint64_t {
+    auto total = count();
+    if (total == 0) { return 0; }
+
+    auto rank = std::max(uint64_t(1), static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5));
+    auto seen = uint64_t(0);
+    for (size_t bucket = 0; bucket < num_buckets; bucket++) {
+        seen += counts.at(bucket);
+        if (seen >= rank) { return highest_value_in(bucket); }
+    }
+
+    return highest_value_in(num_buckets - 1);
+}
+
+auto Scheduler::Histogram::snapshot() const -> HistogramSnapshot {
+    auto snapshot = HistogramSnapshot();
+    for (size_t bucket = 0; bucket < HistogramSnapshot::num_buckets; bucket++) {
+        snapshot.counts.at(bucket) = counts.at(bucket).load(std::memory_order_relaxed);
+    }
+
+    snapshot.sum = sum.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+auto Scheduler::SchedulerMetrics::queue_latency() const -> HistogramSnapshot {
+    auto merged = HistogramSnapshot();
+    for (const auto& worker : workers) { merged.merge(worker.queue_latency); }
+    return merged;
+}
+
+auto Scheduler::SchedulerMetrics::to_prometheus() const -> std::string {
+    auto out = std::ostringstream();
+
+    write_header(out, "async_scheduler_queue_depth", "Jobs queued on a worker's local queue", "gauge");
+    for (size_t worker = 0; worker < workers.size(); worker++) {
+        for (size_t priority = 0; priority < num_priorities; priority++) {
+            out << "async_scheduler_queue_depth{worker=\"" << worker << "\",priority=\"" << priority_names.at(priority) << "\"} "
+                << workers[worker].queue_depth.at(priority) << '\n';
+        }
+    }
+
+    write_header(out, "async_scheduler_active_workers", "Workers currently running in the pool", "gauge");
+    out << "async_scheduler_active_workers " << active_workers << '\n';
+
+    write_header(out, "async_scheduler_blocking_threads", "Threads of the blocking pool", "gauge");
+    out << "async_scheduler_blocking_threads{state=\"idle\"} " << blocking_pool.idle_threads << '\n';
+    out << "async_scheduler_blocking_threads{state=\"busy\"} " << blocking_pool.threads - blocking_pool.idle_threads << '\n';
+    write_header(out, "async_scheduler_blocking_queue_depth", "Jobs queued on the blocking pool", "gauge");
+    out << "async_scheduler_blocking_queue_depth " << blocking_pool.queue_depth << '\n';
+    write_header(out, "async_scheduler_blocking_jobs_run_total", "Jobs run by the blocking pool", "counter");
+    out << "async_scheduler_blocking_jobs_run_total " << blocking_pool.jobs_run << '\n';
+
+    write_header(out, "async_scheduler_global_queue_depth", "Jobs queued on the global queue", "gauge");
+    for (size_t priority = 0; priority < num_priorities; priority++) {
+        out << "async_scheduler_global_queue_depth{priority=\"" << priority_names.at(priority) << "\"} " << global_queue_depth.at(priority) << '\n';
+    }
+
+    auto write_counter = [&](const char* name, const char* help, auto field) {
+        write_header(out, name, help, "counter");
+        for (size_t worker = 0; worker < workers.size(); worker++) {
+            out << name << "{worker=\"" << worker << "\"} " << workers[worker].*field << '\n';
+        }
+    };
+
+    write_counter("async_scheduler_jobs_run_total", "Jobs run by a worker", &WorkerMetrics::jobs_run);
+    write_counter("async_scheduler_steals_total", "Successful steal operations by a worker", &WorkerMetrics::steals);
+    write_counter("async_scheduler_stolen_jobs_total", "Jobs moved onto a worker's queue by its steals", &WorkerMetrics::stolen_jobs);
+    write_counter("async_scheduler_failed_steals_total", "Steal attempts by a worker that found no work", &WorkerMetrics::failed_steals);
+    write_counter("async_scheduler_parks_total", "Times a worker parked for lack of work", &WorkerMetrics::parks);
+
+    write_header(out, "async_scheduler_queue_latency_seconds", "Sampled time from a job being queued to it starting", "summary");
+    write_summary(out, "async_scheduler_queue_latency_seconds", "", queue_latency());
+
+    write_header(out, "async_scheduler_poll_duration_seconds", "Time spent polling a poll source", "summary");
+    for (size_t source = 0; source < poll_sources.size(); source++) {
+        write_summary(out, "async_scheduler_poll_duration_seconds", "source=\"" + std::to_string(source) + '"', poll_sources[source].poll_duration);
+    }
+
+    return out.str();
+}
@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "scheduler/poll_group.h"
+
+Scheduler::PollGroup::PollGroup(PollSources poll_sources) :
+    poll_sources(std::move(poll_sources)),
+    due(this->poll_sources.size(), std::nullopt),
+    poll_counters(this->poll_sources.size())
+{
+    for (auto& source : this->poll_sources) { source->attach(&reactor); }
+}
+
+Scheduler::PollGroup::~PollGroup() {
+    for (auto& source : poll_sources) { source->attach(nullptr); }
+}
+
+auto Scheduler::PollGroup::needs_poll(TimePoint now) const -> bool {
+    return reactor.is_woken() || now.time_since_epoch().count() >= next_due.load(std::memory_order_acquire);
+}
+
+auto Scheduler::PollGroup::deadline() const -> std::optional<TimePoint> {
+    auto due_ticks = next_due.load(std::memory_order_acquire);
+    if (due_ticks == never) { return std::nullopt; }
+    return TimePoint(TimePoint::duration(due_ticks));
+}
+
+auto Scheduler::PollGroup::earliest(std::optional<TimePoint> lhs, std::optional<TimePoint> rhs) -> std::optional<TimePoint> {
+    if (!lhs.has_value() || !rhs.has_value()) { return lhs.has_value() ? lhs : rhs; }
+    return std::min(lhs.value(), rhs.value());
+}
+
+auto Scheduler::PollGroup::metrics() const -> std::vector<PollSourceMetrics> {
+    auto metrics = std::vector<PollSourceMetrics>();
+    metrics.reserve(poll_counters.size());
+    for (const auto& counters : poll_counters) {
+        metrics.push_back(PollSourceMetrics { .polls = counters.polls.load(), .poll_duration = counters.poll_duration.snapshot() });
+    }
+
+    return metrics;
+}
@@ -0,0 +1,72 @@
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "scheduler/reactor.h"
+
+Scheduler::Reactor::Reactor() :
+    epoll_fd(epoll_create1(EPOLL_CLOEXEC)),
+    timer_fd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+    wake_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    for (auto descriptor : { timer_fd, wake_fd }) {
+        auto event = epoll_event { .events = EPOLLIN, .data = { .fd = descriptor } };
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, descriptor, &event);
+    }
+}
+
+Scheduler::Reactor::~Reactor() {
+    close(wake_fd);
+    close(timer_fd);
+    close(epoll_fd);
+}
+
+auto Scheduler::Reactor::wake() -> void {
+    if (wake_pending.exchange(true, std::memory_order_acq_rel)) { return; }
+
+    auto increment = uint64_t(1);
+    static_cast<void>(write(wake_fd, &increment, sizeof(increment)));
+}
+
+auto Scheduler::Reactor::clear_wake() -> void { wake_pending.store(false, std::memory_order_seq_cst); }
+
+// a wake that is still pending has not been consumed by a poll yet (ie. it arrived while a worker held the poll group
+// and the poll thread's own try_poll then failed), its eventfd write may already have been drained and later wakes are
+// coalesced into it, so waiting would miss it until the next deadline. The poll thread instead returns to poll again
+auto Scheduler::Reactor::wait_until(std::optional<TimePoint> deadline) -> void {
+    if (is_woken()) { return; }
+    if (deadline.has_value() && deadline.value() <= std::chrono::steady_clock::now()) { return; }
+
+    arm_timer(deadline);
+    auto events = std::array<epoll_event, 2>();
+    while (epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), -1) < 0 && errno == EINTR) {}
+
+    // both descriptors are non-blocking, drain whichever fired so the next wait blocks again
+    auto counter = uint64_t(0);
+    static_cast<void>(read(wake_fd, &counter, sizeof(counter)));
+    static_cast<void>(read(timer_fd, &counter, sizeof(counter)));
+}
+
+// arm_timer arms the timerfd for an absolute deadline on the monotonic clock (std::chrono::steady_clock is
+// CLOCK_MONOTONIC on Linux), std::nullopt disarms the timer
+auto Scheduler::Reactor::arm_timer(std::optional<TimePoint> deadline) -> void {
+    auto expiry = itimerspec {};
+    if (deadline.has_value()) {
+        auto since_epoch = std::chrono::ceil<std::chrono::nanoseconds>(deadline->time_since_epoch());
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+        expiry.it_value.tv_sec = static_cast<time_t>(seconds.count());
+        expiry.it_value.tv_nsec = static_cast<long>((since_epoch - seconds).count());
+
+        // an all zero it_value disarms the timer, a deadline at the epoch must still fire
+        if (expiry.it_value.tv_sec == 0 && expiry.it_value.tv_nsec == 0) { expiry.it_value.tv_nsec = 1; }
+    }
+
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &expiry, nullptr);
+}
@@ -4,42 +4,60 @@
 #include <stop_token>
 #include <utility>
 
-#include "timing/structures/timing_wheel.h"
+#include "scheduler/poll_group.h"
 #include "scheduler/scheduler.h"
 #include "scheduler/scheduling_context.h"
 #include "scheduler/job.h"
+#include "scheduler/tracer.h"
 
-Scheduler::Scheduler::Scheduler(unsigned int n_workers, const PollSources& poll_sources) : worker_pool(n_workers) {
-    this->poll_thread = std::jthread([this, poll_sources](auto stop) {
-        this->begin_poll(stop, poll_sources);
-    });
+Scheduler::Scheduler::Scheduler(unsigned int n_workers, const PollSources& poll_sources) :
+    Scheduler(SchedulerConfig { .n_workers = n_workers }, poll_sources) {}
+
+Scheduler::Scheduler::Scheduler(const SchedulerConfig& config, const PollSources& poll_sources) :
+    poll_group(poll_sources),
+    worker_pool(config, config.idle_worker_polling ? &poll_group : nullptr),
+    blocking_pool(config.max_blocking_threads, config.blocking_thread_idle_timeout)
+{
+    this->poll_thread = std::jthread([this](auto stop) { this->begin_poll(stop); });
 }
 
-auto Scheduler::Scheduler::queue(Context ctx, Job job_fn) -> void { queue(ctx, std::vector<Job> { job_fn }); }
+auto Scheduler::Scheduler::queue(Context ctx, Job job_fn) -> void { this->worker_pool.queue(ctx, std::move(job_fn)); }
 auto Scheduler::Scheduler::queue(Context ctx, std::vector<Job> jobs) -> void {
     this->worker_pool.queue(ctx, std::move(jobs));
 }
 
-// begin_poll is the main poll loop, it will keep polling the poll sources and scheduling them in the future
-// each poll source has a defined poll frequency, poll sources provide poll frequencies so that they can limit the amount of contention
-// over resources they may be polling over (imagine a timer poll), the function will keep polling until the stop token is triggered
-// after a poll job is complete it will then schedule it n-seconds in the future based on the poll frequency
-auto Scheduler::Scheduler::begin_poll(const std::stop_token& stop_token, PollSources poll_sources) -> void {
-    // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
-    auto poll_scheduler = Timing::TimingWheel<PollSource>(
-        /* wheel_tick_size = */ std::chrono::milliseconds(10),
-        /* num_ticks = */ std::chrono::minutes(1) / std::chrono::milliseconds(10));
-    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
-
-    // initially... schedule all the poll sources for execution
-    auto schedule_poll_source = [&](auto time, auto& source) { poll_scheduler.schedule(time, std::move(source)); };
-    for (auto& source : poll_sources) { schedule_poll_source(std::chrono::milliseconds(0), source); }
-    
-    // now continuously poll the poll sources, only running them when they are scheduled in the future
+auto Scheduler::Scheduler::queue_blocking(Job job_fn) -> void { blocking_pool.queue(std::move(job_fn)); }
+
+auto Scheduler::Scheduler::run_inline(Context ctx, Job& job) -> bool { return worker_pool.run_inline(ctx, job); }
+auto Scheduler::Scheduler::help_until(const std::function<bool()>& done) -> bool { return worker_pool.help_until(done); }
+auto Scheduler::Scheduler::wake_helpers() -> void { worker_pool.wake_helpers(); }
+auto Scheduler::Scheduler::concurrency() const -> unsigned int { return worker_pool.active_workers(); }
+
+auto Scheduler::Scheduler::worker_stats() const -> std::vector<WorkerStats> { return worker_pool.worker_stats(); }
+auto Scheduler::Scheduler::metrics() const -> SchedulerMetrics {
+    auto metrics = worker_pool.metrics();
+    metrics.poll_sources = poll_group.metrics();
+    metrics.blocking_pool = blocking_pool.metrics();
+    return metrics;
+}
+
+// begin_poll is the main poll loop, it sleeps until the poll group comes due (or is woken by one of its sources) and then
+// polls it, queueing the jobs returned by each source onto the global queue. Searching workers poll the group on their
+// own (see WorkerPool::poll_idle) so while any worker is searching the poll thread gives them a short grace period
+// before polling itself. The loop runs until the stop token is triggered.
+auto Scheduler::Scheduler::begin_poll(const std::stop_token& stop_token) -> void {
+    auto wake_on_stop = std::stop_callback(stop_token, [this]() { poll_group.wake(); });
+    Tracer::name_thread("poll");
+
     while (!stop_token.stop_requested()) {
-        for (auto& ready_poll : poll_scheduler.advance()) {
-            queue(Context::empty(), ready_poll->poll());
-            schedule_poll_source(ready_poll->poll_frequency(), ready_poll);
+        poll_group.wait();
+        if (worker_pool.has_idle_pollers()) {
+            poll_group.wait_until(std::chrono::steady_clock::now() + idle_poll_grace);
+            if (!poll_group.needs_poll(std::chrono::steady_clock::now())) { continue; }
         }
+
+        static_cast<void>(poll_group.try_poll([this](std::vector<Job> jobs) {
+            queue(Context::empty(Priority::Latency), std::move(jobs));
+        }));
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,115 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sched.h>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "scheduler/topology.h"
+
+namespace {
+    auto read_id(const std::filesystem::path& path) -> std::optional<unsigned int> {
+        auto file = std::ifstream(path);
+        auto id = 0u;
+        if (!(file >> id)) { return std::nullopt; }
+        return id;
+    }
+
+    // parse_cpu_id parses the N out of a directory named cpuN, returning std::nullopt for anything else (ie. cpufreq)
+    auto parse_cpu_id(const std::string& name) -> std::optional<unsigned int> {
+        const auto prefix = std::string("cpu");
+        if (!name.starts_with(prefix) || name.size() == prefix.size()) { return std::nullopt; }
+
+        auto digits = name.substr(prefix.size());
+        if (!std::ranges::all_of(digits, [](char c) { return c >= '0' && c <= '9'; })) { return std::nullopt; }
+        return static_cast<unsigned int>(std::stoul(digits));
+    }
+
+    // node_of finds the NUMA node of a cpu, the cpu's sysfs directory contains a nodeN link on NUMA capable kernels
+    auto node_of(const std::filesystem::path& cpu_dir) -> std::optional<unsigned int> {
+        auto error = std::error_code();
+        for (const auto& entry : std::filesystem::directory_iterator(cpu_dir, error)) {
+            auto name = entry.path().filename().string();
+            if (name.starts_with("node") && name.size() > 4) {
+                return static_cast<unsigned int>(std::stoul(name.substr(4)));
+            }
+        }
+
+        return std::nullopt;
+    }
+}
+
+Scheduler::Topology::Topology(std::vector<Cpu> cpus) : ordered_cpus(std::move(cpus)) {
+    std::ranges::sort(ordered_cpus, [](const Cpu& lhs, const Cpu& rhs) {
+        return std::tie(lhs.node, lhs.llc, lhs.core, lhs.id) < std::tie(rhs.node, rhs.llc, rhs.core, rhs.id);
+    });
+}
+
+// discover reads the topology of every online cpu from sysfs, core ids in sysfs are only unique within a package
+// hence cores are identified by their (package, core) pair. CPUs without an L3 share a "cache" with their package.
+auto Scheduler::Topology::discover(const std::string& sysfs_cpu_root) -> std::optional<Topology> {
+    auto error = std::error_code();
+    auto core_ids = std::map<std::pair<unsigned int, unsigned int>, unsigned int>();
+    auto cpus = std::vector<Cpu>();
+
+    for (const auto& entry : std::filesystem::directory_iterator(sysfs_cpu_root, error)) {
+        auto cpu_id = parse_cpu_id(entry.path().filename().string());
+        if (!cpu_id.has_value()) { continue; }
+
+        // cpu0 usually has no online file as it cannot be taken offline
+        if (read_id(entry.path() / "online").value_or(1) == 0) { continue; }
+        if (!can_pin(cpu_id.value())) { continue; }
+
+        auto package = read_id(entry.path() / "topology" / "physical_package_id");
+        auto core = read_id(entry.path() / "topology" / "core_id");
+        if (!package.has_value() || !core.has_value()) { continue; }
+
+        auto [core_entry, _] = core_ids.try_emplace({ package.value(), core.value() }, static_cast<unsigned int>(core_ids.size()));
+        cpus.push_back(Cpu {
+            .id = cpu_id.value(),
+            .core = core_entry->second,
+            .llc = read_id(entry.path() / "cache" / "index3" / "id").value_or(package.value()),
+            .node = node_of(entry.path()).value_or(package.value()),
+        });
+    }
+
+    if (error || cpus.empty()) { return std::nullopt; }
+    return Topology(std::move(cpus));
+}
+
+auto Scheduler::Topology::from_file(const std::string& path) -> std::optional<Topology> {
+    auto file = std::ifstream(path);
+    if (!file.is_open()) { return std::nullopt; }
+
+    auto cpus = std::vector<Cpu>();
+    auto line = std::string();
+    while (std::getline(file, line)) {
+        if (line.empty() || line.starts_with('#')) { continue; }
+
+        auto cpu = Cpu {};
+        auto fields = std::istringstream(line);
+        if (!(fields >> cpu.id >> cpu.core >> cpu.llc >> cpu.node)) { return std::nullopt; }
+        cpus.push_back(cpu);
+    }
+
+    if (cpus.empty()) { return std::nullopt; }
+    return Topology(std::move(cpus));
+}
+
+auto Scheduler::Topology::can_pin(unsigned int cpu) -> bool {
+    auto cpu_set = cpu_set_t();
+    CPU_ZERO(&cpu_set);
+    if (cpu >= CPU_SETSIZE || sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) { return false; }
+    return CPU_ISSET(cpu, &cpu_set);
+}
+
+auto Scheduler::Topology::tier(const Cpu& thief, const Cpu& victim) -> StealTier {
+    if (thief.core == victim.core) { return StealTier::SmtSibling; }
+    if (thief.llc == victim.llc || thief.node == victim.node) { return StealTier::SameNode; }
+    return StealTier::Remote;
+}
@@ -0,0 +1,172 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "scheduler/tracer.h"
+
+namespace {
+    struct RecordedEvent {
+        int64_t timestamp;
+        uint64_t arg;
+        Scheduler::TraceEvent event;
+    };
+
+    // TraceBuffer is a single producer ring buffer of events, the producer publishes each event by advancing head
+    class TraceBuffer {
+    public:
+        TraceBuffer(size_t thread_id, std::string thread_name) : thread_id(thread_id), thread_name(std::move(thread_name)), events(capacity) {}
+
+        auto push(RecordedEvent event) -> void {
+            auto index = head.load(std::memory_order_relaxed);
+            events[index & (capacity - 1)] = event;
+            head.store(index + 1, std::memory_order_release);
+        }
+
+        // for_each invokes fn with every event still held by the buffer, oldest first
+        template <typename Fn>
+        auto for_each(Fn&& fn) const -> void {
+            auto end = head.load(std::memory_order_acquire);
+            auto begin = end > capacity ? end - capacity : 0;
+            for (auto index = begin; index < end; index++) { fn(events[index & (capacity - 1)]); }
+        }
+
+        size_t thread_id;
+        std::string thread_name;
+        // owner_exited is set once the recording thread has exited, its buffer is then dropped by the next start
+        std::atomic<bool> owner_exited = { false };
+
+    private:
+        constexpr static size_t capacity = size_t(1) << 16;
+
+        std::vector<RecordedEvent> events;
+        std::atomic<size_t> head = { 0 };
+    };
+
+    // buffers holds every thread's buffer, it is only locked when a thread records its first event, when writing and
+    // when starting. Thread ids are never reused (even once the buffer of an exited thread has been dropped)
+    std::mutex buffers_lock;
+    std::vector<std::shared_ptr<TraceBuffer>> buffers;
+    size_t next_thread_id = 0;
+    std::atomic<int64_t> trace_start = { 0 };
+
+    struct ThreadTrace {
+        ThreadTrace() = default;
+        ThreadTrace(const ThreadTrace&) = delete;
+        ThreadTrace(ThreadTrace&&) = delete;
+        auto operator=(const ThreadTrace&) -> ThreadTrace& = delete;
+        auto operator=(ThreadTrace&&) -> ThreadTrace& = delete;
+        ~ThreadTrace() {
+            if (buffer != nullptr) { buffer->owner_exited.store(true, std::memory_order_release); }
+        }
+
+        std::string name;
+        std::shared_ptr<TraceBuffer> buffer;
+    };
+
+    thread_local auto thread_trace = ThreadTrace();
+
+    auto now() -> int64_t {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    auto local_buffer() -> TraceBuffer& {
+        if (thread_trace.buffer == nullptr) {
+            const auto lock = std::lock_guard(buffers_lock);
+            auto thread_id = next_thread_id++;
+            auto name = thread_trace.name.empty() ? "thread " + std::to_string(thread_id) : thread_trace.name;
+            thread_trace.buffer = buffers.emplace_back(std::make_shared<TraceBuffer>(thread_id, std::move(name)));
+        }
+
+        return *thread_trace.buffer;
+    }
+
+    // write_event writes a single trace event, JobBegin/JobEnd and PollBegin/PollEnd become duration slices and
+    // everything else becomes a thread scoped instant
+    auto write_event(std::ostream& out, const TraceBuffer& buffer, const RecordedEvent& recorded, int64_t start) -> void {
+        constexpr auto priority_names = std::array { "latency", "normal", "background" };
+        constexpr double nanoseconds_per_microsecond = 1000.0;
+
+        auto timestamp = static_cast<double>(recorded.timestamp - start) / nanoseconds_per_microsecond;
+        out << ",\n{\"pid\":1,\"tid\":" << buffer.thread_id << ",\"ts\":" << timestamp << ',';
+        switch (recorded.event) {
+            case Scheduler::TraceEvent::JobBegin:
+                out << R"("ph":"B","name":"job","args":{"priority":")" << priority_names.at(recorded.arg % priority_names.size()) << "\"}}";
+                break;
+            case Scheduler::TraceEvent::JobEnd: out << R"("ph":"E","name":"job"})"; break;
+            case Scheduler::TraceEvent::PollBegin: out << R"("ph":"B","name":"poll"})"; break;
+            case Scheduler::TraceEvent::PollEnd: out << R"("ph":"E","name":"poll"})"; break;
+            case Scheduler::TraceEvent::Enqueue:
+                out << R"("ph":"i","s":"t","name":"enqueue","args":{"jobs":)" << recorded.arg << "}}";
+                break;
+            case Scheduler::TraceEvent::Steal:
+                out << R"("ph":"i","s":"t","name":"steal","args":{"jobs":)" << recorded.arg << "}}";
+                break;
+            case Scheduler::TraceEvent::CellWrite:
+                out << R"("ph":"i","s":"t","name":"cell write","args":{"cell":")" << std::hex << recorded.arg << std::dec << "\"}}";
+                break;
+            case Scheduler::TraceEvent::CellAwait:
+                out << R"("ph":"i","s":"t","name":"cell await","args":{"cell":")" << std::hex << recorded.arg << std::dec << "\"}}";
+                break;
+        }
+    }
+}
+
+// the buffers of threads that have exited only hold events from before this start, hence they are dropped rather than
+// being kept around (elastic and blocking pool threads come and go, each with a buffer of their own)
+auto Scheduler::Tracer::start() -> void {
+    {
+        const auto lock = std::lock_guard(buffers_lock);
+        std::erase_if(buffers, [](const auto& buffer) { return buffer->owner_exited.load(std::memory_order_acquire); });
+    }
+
+    trace_start.store(now(), std::memory_order_relaxed);
+    enabled.store(true, std::memory_order_release);
+}
+
+auto Scheduler::Tracer::stop() -> void { enabled.store(false, std::memory_order_release); }
+
+auto Scheduler::Tracer::name_thread(std::string name) -> void {
+    thread_trace.name = std::move(name);
+    if (thread_trace.buffer != nullptr) {
+        const auto lock = std::lock_guard(buffers_lock);
+        thread_trace.buffer->thread_name = thread_trace.name;
+    }
+}
+
+auto Scheduler::Tracer::record(TraceEvent event, uint64_t arg) -> void {
+    local_buffer().push(RecordedEvent { .timestamp = now(), .arg = arg, .event = event });
+}
+
+// timestamps are written in microseconds (as the trace event format requires) with a fixed nanosecond fraction, the
+// stream's default precision would round them to 10us once a trace runs past a second. The stream's formatting is restored
+// once the trace has been written
+auto Scheduler::Tracer::write_chrome_trace(std::ostream& out) -> void {
+    const auto lock = std::lock_guard(buffers_lock);
+    auto start = trace_start.load(std::memory_order_relaxed);
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+
+    out << R"({"displayTimeUnit":"ns","traceEvents":[)" << '\n';
+    out << R"({"pid":1,"ph":"M","name":"process_name","args":{"name":"async_lib"}})";
+    for (const auto& buffer : buffers) {
+        out << ",\n{\"pid\":1,\"tid\":" << buffer->thread_id << R"(,"ph":"M","name":"thread_name","args":{"name":")" << buffer->thread_name << "\"}}";
+        buffer->for_each([&](const RecordedEvent& recorded) {
+            if (recorded.timestamp >= start) { write_event(out, *buffer, recorded, start); }
+        });
+    }
+
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
@@ -1,42 +1,399 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <pthread.h>
+#include <sched.h>
 #include <utility>
 #include <optional>
-#include <vector>
+#include <span>
 #include <thread>
+#include <stop_token>
+#include <string>
+#include <vector>
 
 #include "scheduler/worker.h"
+#include "scheduler/worker_pool.h"
 #include "scheduler/scheduling_context.h"
 #include "scheduler/job.h"
-#include "scheduler/job_queue.h"
+#include "scheduler/tracer.h"
 
-Scheduler::JobWorker::JobWorker(Context worker_context, StealWork steal_work) : 
-    worker_context(worker_context), 
-    steal_work(std::move(steal_work)),
-    worker_thread(std::nullopt) {}
+namespace {
+    // current_worker is the worker that owns the current thread (if any), it allows the pool to determine
+    // if a job can be pushed directly onto a worker's deque
+    thread_local Scheduler::JobWorker* current_worker = nullptr;
+
+}
+
+Scheduler::JobWorker::JobWorker(Context worker_context, WorkerPool& pool, std::optional<unsigned int> cpu) :
+    worker_context(worker_context),
+    pool(pool),
+    cpu(cpu),
+    worker_thread(std::nullopt),
+    // xorshift has a fixed point at zero so derive a non-zero seed from the worker's id
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    rng_state((worker_context.worker_id.value_or(0) + 1) * 0x9E3779B9U) {}
 
 auto Scheduler::JobWorker::start() -> bool {
-    if (worker_thread.has_value()) {
+    if (is_running()) {
         return false;
     }
 
-    worker_thread = std::jthread([this](auto stop_token) {
-        while (!stop_token.stop_requested()) {
-            if (auto job = job_queue.dequeue(); job.has_value()) {
-                job.value()(this->worker_context);
-            } else {
-                if (auto job = steal_work(); job.has_value()) {
-                    job.value()(this->worker_context);
-                }
-            }
+    join();
+    running.store(true, std::memory_order_release);
+    worker_thread = std::jthread([this](const std::stop_token& stop_token) { run(stop_token); });
+    return true;
+}
+
+// run is the main loop of the worker, the worker prefers jobs from its own queue and then looks for work via the pool.
+// When no work can be found the worker enters an idle phase: it spins for idle_spin_rounds, yields its time slice for
+// idle_yield_rounds and then finally parks until the pool is handed more work. While spinning or yielding the worker
+// is considered to be "searching" for work, the pool uses this to avoid waking parked workers unnecessarily. Searching
+// workers also poll the scheduler's poll sources once they come due. A worker of an elastic pool exits the loop once the
+// pool retires it.
+auto Scheduler::JobWorker::run(const std::stop_token& stop_token) -> void {
+    current_worker = this;
+    Tracer::name_thread("worker " + std::to_string(worker_context.worker_id.value_or(0)));
+    pin_to_cpu();
+    for (auto& queue : job_queues) { queue.reserve(queue_capacity); }
+
+    auto idle_rounds = 0u;
+    auto priority = Priority::Normal;
+    while (!stop_token.stop_requested()) {
+        if (auto job = next_job(priority); job.has_value()) {
+            if (idle_rounds > 0) { pool.get().stop_searching(/* found_work = */ true); }
+            idle_rounds = 0;
+            run_job(job.value(), priority);
+            continue;
         }
-    });   
 
-    return true;
+        if (idle_rounds == 0) { pool.get().start_searching(); }
+        idle_rounds += 1;
+
+        // searching workers poll any due poll sources themselves, the completions land on this worker's own queue
+        pool.get().poll_idle(worker_context);
+
+        if (idle_rounds <= idle_spin_rounds) {
+            __builtin_ia32_pause();
+        } else if (idle_rounds <= idle_spin_rounds + idle_yield_rounds) {
+            std::this_thread::yield();
+        } else {
+            pool.get().stop_searching(/* found_work = */ false);
+            if (!pool.get().park(*this, stop_token)) { break; }
+            idle_rounds = 0;
+        }
+    }
+
+    running.store(false, std::memory_order_seq_cst);
+    release_injected();
+}
+
+// help_until is a nested run loop, the jobs it runs may themselves block and help in turn. The helper does not count
+// as searching (it is not available to run newly queued work for as long as its caller holds the thread)
+auto Scheduler::JobWorker::help_until(const std::function<bool()>& done) -> void {
+    auto idle_rounds = 0u;
+    auto priority = Priority::Normal;
+    while (!done()) {
+        if (auto job = next_job(priority); job.has_value()) {
+            idle_rounds = 0;
+            run_job(job.value(), priority);
+            continue;
+        }
+
+        idle_rounds += 1;
+        pool.get().poll_idle(worker_context);
+
+        if (idle_rounds <= idle_spin_rounds) {
+            __builtin_ia32_pause();
+        } else if (idle_rounds <= idle_spin_rounds + idle_yield_rounds) {
+            std::this_thread::yield();
+        } else {
+            pool.get().park_helper(*this, done);
+            idle_rounds = 0;
+        }
+    }
+}
+
+auto Scheduler::JobWorker::run_job(Job& job, Priority priority) -> void {
+    Tracer::trace(TraceEvent::JobBegin, static_cast<uint64_t>(priority));
+    job(worker_context.with_priority(priority));
+    Tracer::trace(TraceEvent::JobEnd);
+    worker_counters.jobs_run.increment();
+}
+
+// Note: the size checks are not required for correctness, they exist as popping from an empty deque (or claiming from an
+//       empty global queue) requires a full fence, and the higher priority queues are usually empty
+auto Scheduler::JobWorker::next_job(Priority& priority) -> std::optional<Job> {
+    if (auto job = check_global(priority); job.has_value()) { return job; }
+
+    for (auto level = size_t(0); level < num_priorities; level++) {
+        priority = static_cast<Priority>(level);
+        auto spilled = false;
+        if (auto job = take_lifo(priority, spilled); job.has_value()) { return job; }
+        if (spilled) {
+            if (auto job = job_queue(priority).steal(); job.has_value()) { return job; }
+        }
+
+        if (job_queue(priority).size() > 0) {
+            if (auto job = job_queue(priority).pop(); job.has_value()) { return job; }
+        }
+
+        if (auto job = take_injected(priority); job.has_value()) { return job; }
+        if (auto job = pool.get().take_global(*this, priority); job.has_value()) { return job; }
+    }
+
+    for (auto level = size_t(0); level < num_priorities; level++) {
+        priority = static_cast<Priority>(level);
+        if (auto job = pool.get().steal_work(*this, priority); job.has_value()) { return job; }
+    }
+
+    return std::nullopt;
 }
 
-auto Scheduler::JobWorker::steal_job() -> std::optional<Job> { return job_queue.dequeue(); }
-auto Scheduler::JobWorker::queue(Job job) -> void { queue(std::vector { std::move(job) });}
-auto Scheduler::JobWorker::queue(std::vector<Job> jobs) -> void {
-    for (auto& job : jobs) {
-        job_queue.enqueue(std::move(job));
+// check_global runs every global_check_interval jobs, without it a worker whose jobs keep queueing local work (ie. a
+// chain of continuations) would starve the global queues and leave due timers and IO completions to the poll thread
+// which competes with the busy workers for a CPU. Completions from the poll land on the local Latency queue. The
+// injected jobs are checked alongside the global queues as they would otherwise starve in just the same way
+auto Scheduler::JobWorker::check_global(Priority& priority) -> std::optional<Job> {
+    jobs_since_global_check += 1;
+    if (jobs_since_global_check < global_check_interval) { return std::nullopt; }
+    jobs_since_global_check = 0;
+
+    pool.get().poll_idle(worker_context);
+    for (auto level = size_t(0); level < num_priorities; level++) {
+        priority = static_cast<Priority>(level);
+        if (auto job = take_injected(priority); job.has_value()) { return job; }
+        if (auto job = pool.get().take_global(*this, priority); job.has_value()) { return job; }
     }
-}
\ No newline at end of file
+
+    return std::nullopt;
+}
+
+auto Scheduler::JobWorker::request_stop() -> void {
+    if (worker_thread.has_value()) { worker_thread->request_stop(); }
+}
+
+auto Scheduler::JobWorker::join() -> void {
+    if (worker_thread.has_value() && worker_thread->joinable()) { worker_thread->join(); }
+}
+
+auto Scheduler::JobWorker::is_current_thread() const -> bool { return current_worker == this; }
+auto Scheduler::JobWorker::current() -> JobWorker* { return current_worker; }
+auto Scheduler::JobWorker::queue_size() const -> size_t {
+    auto size = lifo_state.load(std::memory_order_relaxed) == SlotState::Empty ? size_t(0) : size_t(1);
+    for (const auto& queue : job_queues) { size += queue.size(); }
+    for (const auto& queue : inject_queues) { size += queue.size(); }
+    return size;
+}
+
+auto Scheduler::JobWorker::steal_job(Priority priority) -> std::optional<Job> { return job_queue(priority).steal(); }
+
+// steal_half moves half of the victim's queue (rounded up) over to the thief. A Chase-Lev deque cannot hand out a range
+// with a single CAS on top as the owner pops from the bottom without synchronising unless exactly one job remains, hence
+// the batch is claimed one job at a time. The thief only pushes to its own deque so the batch never leaves its owner's hands.
+// A victim with nothing left on its deque or in its LIFO slot gives up a single injected job
+auto Scheduler::JobWorker::steal_half(JobWorker& thief, Priority priority, StealTier tier) -> std::optional<Job> {
+    auto& victim_queue = job_queue(priority);
+    auto batch_size = (victim_queue.size() + 1) / 2;
+    auto job = victim_queue.steal();
+    if (!job.has_value()) {
+        job = steal_lifo(priority);
+        if (!job.has_value() && inject_queue(priority).size() > 0) { job = inject_queue(priority).try_dequeue(); }
+        if (!job.has_value()) { return std::nullopt; }
+        batch_size = 1;
+    }
+
+    auto n_stolen = uint64_t(1);
+    for (; n_stolen < batch_size; n_stolen++) {
+        auto surplus = victim_queue.steal();
+        if (!surplus.has_value()) { break; }
+        thief.queue(priority, std::move(surplus.value()));
+    }
+
+    thief.steals.fetch_add(1, std::memory_order_relaxed);
+    thief.stolen_jobs.fetch_add(n_stolen, std::memory_order_relaxed);
+    Tracer::trace(TraceEvent::Steal, n_stolen);
+    thief.tier_steals.at(static_cast<size_t>(tier)).fetch_add(1, std::memory_order_relaxed);
+    return job;
+}
+
+auto Scheduler::JobWorker::add_victim(StealTier tier, JobWorker& victim) -> void {
+    victim_tiers.at(static_cast<size_t>(tier)).push_back(&victim);
+}
+
+auto Scheduler::JobWorker::victims(StealTier tier) const -> std::span<JobWorker* const> {
+    return victim_tiers.at(static_cast<size_t>(tier));
+}
+
+auto Scheduler::JobWorker::pin_to_cpu() const -> void {
+    if (!cpu.has_value() || cpu.value() >= CPU_SETSIZE) { return; }
+
+    auto cpu_set = cpu_set_t();
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu.value(), &cpu_set);
+    static_cast<void>(pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set));
+}
+
+auto Scheduler::JobWorker::next_random() -> uint32_t {
+    // NOLINTBEGIN(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    // NOLINTEND(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
+    return rng_state;
+}
+
+auto Scheduler::JobWorker::stats() const -> WorkerStats {
+    auto steals_by_tier = std::array<uint64_t, num_steal_tiers>();
+    for (auto tier = size_t(0); tier < num_steal_tiers; tier++) {
+        steals_by_tier.at(tier) = tier_steals.at(tier).load(std::memory_order_relaxed);
+    }
+
+    return WorkerStats {
+        .steals = steals.load(std::memory_order_relaxed),
+        .stolen_jobs = stolen_jobs.load(std::memory_order_relaxed),
+        .steals_by_tier = steals_by_tier,
+    };
+}
+
+auto Scheduler::JobWorker::queue(Priority priority, Job job) -> void { job_queue(priority).push(std::move(job)); }
+
+// push_lifo spills the slot's current job onto the deque, if a thief is claiming the slot the new job is pushed onto
+// the deque instead (the slot would only be empty again once the thief is done). An empty slot may have just been
+// emptied by a thief, the acquire load pairs with the thief's release of the slot so its move out of lifo_job happens
+// before the job is emplaced
+auto Scheduler::JobWorker::push_lifo(Priority priority, Job job) -> bool {
+    auto displaced = false;
+    if (lifo_state.load(std::memory_order_acquire) != SlotState::Empty) {
+        auto previous = claim_lifo(lifo_priority.load(std::memory_order_relaxed));
+        if (!previous.has_value()) {
+            queue(priority, std::move(job));
+            return true;
+        }
+
+        queue(lifo_priority.load(std::memory_order_relaxed), std::move(previous.value()));
+        displaced = true;
+    }
+
+    lifo_job.emplace(std::move(job));
+    lifo_priority.store(priority, std::memory_order_relaxed);
+    lifo_filled_at.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    lifo_state.store(SlotState::Full, std::memory_order_release);
+    return displaced;
+}
+
+auto Scheduler::JobWorker::take_lifo(Priority priority, bool& spilled) -> std::optional<Job> {
+    // an empty slot means the worker moves on to older work, which ends the slot's streak
+    if (lifo_state.load(std::memory_order_relaxed) != SlotState::Full) {
+        lifo_streak = 0;
+        return std::nullopt;
+    }
+
+    if (lifo_priority.load(std::memory_order_relaxed) != priority) { return std::nullopt; }
+
+    auto job = claim_lifo(priority);
+    if (job.has_value() && lifo_streak >= lifo_budget) {
+        queue(priority, std::move(job.value()));
+        lifo_streak = 0;
+        spilled = true;
+        return std::nullopt;
+    }
+
+    lifo_streak += job.has_value() ? 1 : 0;
+    return job;
+}
+
+auto Scheduler::JobWorker::steal_lifo(Priority priority) -> std::optional<Job> {
+    if (lifo_state.load(std::memory_order_acquire) != SlotState::Full) { return std::nullopt; }
+
+    auto filled_at = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(lifo_filled_at.load(std::memory_order_relaxed)));
+    if (std::chrono::steady_clock::now() - filled_at < lifo_grace) { return std::nullopt; }
+    return claim_lifo(priority);
+}
+
+// claim_lifo moves the job out of the slot if it holds a job of the given priority, the owner and thieves race to
+// claim the slot hence the slot is claimed with a CAS before the job is touched
+auto Scheduler::JobWorker::claim_lifo(Priority priority) -> std::optional<Job> {
+    auto expected = SlotState::Full;
+    if (!lifo_state.compare_exchange_strong(expected, SlotState::Claimed, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return std::nullopt;
+    }
+
+    if (lifo_priority.load(std::memory_order_relaxed) != priority) {
+        lifo_state.store(SlotState::Full, std::memory_order_release);
+        return std::nullopt;
+    }
+
+    auto job = std::move(lifo_job);
+    lifo_job.reset();
+    lifo_state.store(SlotState::Empty, std::memory_order_release);
+    return job;
+}
+
+auto Scheduler::JobWorker::queue(Priority priority, std::span<Job> jobs) -> void {
+    job_queue(priority).push_bulk(jobs.begin(), jobs.size());
+}
+
+auto Scheduler::JobWorker::inject(Priority priority, Job job) -> void {
+    inject_queue(priority).enqueue(std::move(job));
+    if (!running.load(std::memory_order_seq_cst)) { release_injected(); }
+}
+
+auto Scheduler::JobWorker::inject(Priority priority, std::span<Job> jobs) -> void {
+    inject_queue(priority).enqueue_bulk(jobs.begin(), jobs.size());
+    if (!running.load(std::memory_order_seq_cst)) { release_injected(); }
+}
+
+// as with take_global the surplus is pushed in reverse so that the injected jobs still run in FIFO order
+auto Scheduler::JobWorker::take_injected(Priority priority) -> std::optional<Job> {
+    auto& injected = inject_queue(priority);
+    if (injected.size() == 0) { return std::nullopt; }
+
+    thread_local auto batch = std::vector<Job>();
+    if (injected.try_dequeue_bulk(std::back_inserter(batch), max_inject_batch) == 0) {
+        return std::nullopt;
+    }
+
+    auto job = std::optional(std::move(batch.front()));
+    auto surplus = std::span(batch).subspan(1);
+    std::ranges::reverse(surplus);
+    queue(priority, surplus);
+
+    batch.clear();
+    return job;
+}
+
+auto Scheduler::JobWorker::release_injected() -> void {
+    auto released = std::vector<Job>();
+    for (auto level = size_t(0); level < num_priorities; level++) {
+        auto priority = static_cast<Priority>(level);
+        while (inject_queue(priority).try_dequeue_bulk(std::back_inserter(released), max_inject_batch) > 0) {}
+        if (released.empty()) { continue; }
+
+        pool.get().global_queue(priority).enqueue_bulk(released.begin(), released.size());
+        pool.get().notify_workers(released.size());
+        released.clear();
+    }
+}
+
+auto Scheduler::JobWorker::metrics() const -> WorkerMetrics {
+    auto worker_stats = stats();
+    auto queue_depth = std::array<size_t, num_priorities>();
+    for (auto level = size_t(0); level < num_priorities; level++) { queue_depth.at(level) = job_queues.at(level).size() + inject_queues.at(level).size(); }
+    if (lifo_state.load(std::memory_order_relaxed) != SlotState::Empty) {
+        queue_depth.at(static_cast<size_t>(lifo_priority.load(std::memory_order_relaxed))) += 1;
+    }
+
+    return WorkerMetrics {
+        .queue_depth = queue_depth,
+        .jobs_run = worker_counters.jobs_run.load(),
+        .steals = worker_stats.steals,
+        .stolen_jobs = worker_stats.stolen_jobs,
+        .failed_steals = worker_counters.failed_steals.load(),
+        .parks = worker_counters.parks.load(),
+        .queue_latency = worker_counters.queue_latency.snapshot(),
+    };
+}
@@ -1,65 +1,402 @@
 #include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stop_token>
 #include <utility>
 #include <vector>
 #include <optional>
-#include <random>
 #include <cstddef>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include <thread>
 
+#include "concurrency/slab_allocator.h"
 #include "scheduler/worker_pool.h"
+#include "scheduler/metrics.h"
 #include "scheduler/worker.h"
 #include "scheduler/job.h"
 #include "scheduler/scheduling_context.h"
+#include "scheduler/tracer.h"
 
-Scheduler::WorkerPool::WorkerPool(unsigned int n_workers) {
-    for (unsigned int i = 0; i < n_workers; i++) {
-        auto worker = JobWorker(Context(i), [this]() { return this->find_new_work(); });
-        workers.emplace_back(std::move(worker));
+namespace {
+    // SlabJobBox owns a job boxed in the calling thread's slab arena
+    struct SlabJobDeleter {
+        auto operator()(Scheduler::Job* job) const noexcept -> void {
+            std::destroy_at(job);
+            SlabArena::deallocate(job);
+        }
+    };
+
+    using SlabJobBox = std::unique_ptr<Scheduler::Job, SlabJobDeleter>;
+
+    // inline_depth is the number of inline jobs running on the calling thread's stack
+    thread_local unsigned int inline_depth = 0;
+}
+
+Scheduler::WorkerPool::WorkerPool(unsigned int n_workers) : WorkerPool(SchedulerConfig { .n_workers = n_workers }) {}
+
+Scheduler::WorkerPool::WorkerPool(const SchedulerConfig& config, PollGroup* poll_group) :
+    poll_group(poll_group),
+    lifo_slot(config.lifo_slot),
+    min_workers(config.n_workers),
+    grow_after(config.grow_after),
+    grow_queue_depth(config.grow_queue_depth),
+    idle_worker_timeout(config.idle_worker_timeout) {
+    auto topology = load_topology(config);
+    auto n_slots = std::max(config.n_workers, config.max_workers.value_or(config.n_workers));
+    // a worker is only placed on a discovered cpu it can be pinned to, an unplaced worker runs unpinned and is a remote
+    // victim of every other worker. Simulated topologies are placed regardless as their cpus need not exist
+    auto placement = std::vector<std::optional<Cpu>>(n_slots, std::nullopt);
+    for (unsigned int i = 0; i < n_slots; i++) {
+        if (topology.has_value()) { placement[i] = topology->cpus()[i % topology->cpus().size()]; }
+        if (placement[i].has_value() && !config.topology_file.has_value() && !Topology::can_pin(placement[i]->id)) { placement[i] = std::nullopt; }
+
+        auto cpu = placement[i].has_value() ? std::optional(placement[i]->id) : std::nullopt;
+        workers.push_back(std::make_unique<JobWorker>(Context(i), *this, cpu));
     }
 
-    // start all the workers
-    for (auto& worker : workers) {
-        auto could_start = worker.start();
+    // without a topology every other worker is an equally good victim, they are all placed in a single (remote) tier
+    for (size_t thief = 0; thief < workers.size(); thief++) {
+        for (size_t victim = 0; victim < workers.size(); victim++) {
+            if (thief == victim) { continue; }
+
+            auto placed = placement[thief].has_value() && placement[victim].has_value();
+            auto tier = placed ? Topology::tier(placement[thief].value(), placement[victim].value()) : StealTier::Remote;
+            workers[thief]->add_victim(tier, *workers[victim]);
+        }
+    }
+
+    // start the first n_workers workers, the remaining slots of an elastic pool are started by the supervisor
+    for (unsigned int i = 0; i < min_workers; i++) {
+        auto could_start = workers[i]->start();
         if (!could_start) {
             assert(false && "Failed to start worker");
         }
     }
+
+    running_workers.store(min_workers, std::memory_order_relaxed);
+    if (is_elastic()) {
+        supervisor = std::jthread([this](const std::stop_token& stop_token) { supervise(stop_token); });
+    }
+}
+
+Scheduler::WorkerPool::~WorkerPool() {
+    // the supervisor is stopped first as it is the only thread that starts workers
+    if (supervisor.has_value()) {
+        supervisor->request_stop();
+        supervisor->join();
+    }
+
+    for (auto& worker : workers) { worker->request_stop(); }
+    idle_workers.notify_all();
+    for (auto& worker : workers) { worker->join(); }
+}
+
+auto Scheduler::WorkerPool::queue(Context ctx, Job job) -> void {
+    sample_queue_latency(job);
+    Tracer::trace(TraceEvent::Enqueue, 1);
+
+    // a job that lands in the (previously empty) LIFO slot runs next on the queueing worker, there is no work to wake
+    // another worker for. Only once it has waited out its grace period may a searching worker steal it
+    if (auto* worker = local_worker(ctx); worker != nullptr && lifo_slot) {
+        if (worker->push_lifo(ctx.priority(), std::move(job))) { notify_workers(1); }
+        return;
+    }
+
+    if (auto* worker = local_worker(ctx); worker != nullptr) {
+        worker->queue(ctx.priority(), std::move(job));
+    } else if (auto* target = named_worker(ctx); target != nullptr) {
+        target->inject(ctx.priority(), std::move(job));
+    } else {
+        global_queue(ctx.priority()).enqueue(std::move(job));
+    }
+
+    notify_workers(1);
 }
 
-auto Scheduler::WorkerPool::queue(Context ctx, Job job) -> void { queue(ctx, std::vector<Job> { std::move(job) }); }
 auto Scheduler::WorkerPool::queue(Context ctx, std::vector<Job> jobs) -> void {
-    auto worker_id = ctx.worker_id;
-    if (worker_id.has_value()) {
-        auto& worker = workers[worker_id.value()];
-        worker.queue(std::move(jobs));
+    if (jobs.empty()) { return; }
+    for (auto& job : jobs) { sample_queue_latency(job); }
+
+    if (auto* worker = local_worker(ctx); worker != nullptr) {
+        worker->queue(ctx.priority(), std::span(jobs));
+    } else if (auto* target = named_worker(ctx); target != nullptr) {
+        target->inject(ctx.priority(), std::span(jobs));
     } else {
-        for (auto& job : jobs) {
-            global_queue.enqueue(std::move(job));
+        global_queue(ctx.priority()).enqueue_bulk(jobs.begin(), jobs.size());
+    }
+
+    Tracer::trace(TraceEvent::Enqueue, jobs.size());
+    notify_workers(jobs.size());
+}
+
+auto Scheduler::WorkerPool::run_inline(Context ctx, Job& job) -> bool {
+    auto* worker = local_worker(ctx);
+    if (worker == nullptr || inline_depth >= max_inline_depth) { return false; }
+
+    inline_depth += 1;
+    job(worker->context().with_priority(ctx.priority()));
+    inline_depth -= 1;
+    return true;
+}
+
+auto Scheduler::WorkerPool::local_worker(Context ctx) const -> JobWorker* {
+    auto worker_id = ctx.worker_id;
+    if (!worker_id.has_value()) {
+        auto* current = JobWorker::current();
+        return current != nullptr && &current->owner() == this ? current : nullptr;
+    }
+
+    if (worker_id.has_value() && worker_id.value() < workers.size() && workers[worker_id.value()]->is_current_thread()) {
+        return workers[worker_id.value()].get();
+    }
+
+    return nullptr;
+}
+
+auto Scheduler::WorkerPool::named_worker(Context ctx) const -> JobWorker* {
+    auto worker_id = ctx.worker_id;
+    if (worker_id.has_value() && worker_id.value() < workers.size() && workers[worker_id.value()]->is_running()) {
+        return workers[worker_id.value()].get();
+    }
+
+    return nullptr;
+}
+
+auto Scheduler::WorkerPool::worker_stats() const -> std::vector<WorkerStats> {
+    auto stats = std::vector<WorkerStats>();
+    stats.reserve(workers.size());
+    for (const auto& worker : workers) {
+        stats.push_back(worker->stats());
+    }
+
+    return stats;
+}
+
+auto Scheduler::WorkerPool::metrics() const -> SchedulerMetrics {
+    auto metrics = SchedulerMetrics();
+    metrics.workers.reserve(workers.size());
+    for (const auto& worker : workers) { metrics.workers.push_back(worker->metrics()); }
+    metrics.active_workers = active_workers();
+    for (auto level = size_t(0); level < num_priorities; level++) { metrics.global_queue_depth.at(level) = global_queues.at(level).size(); }
+
+    return metrics;
+}
+
+// the sampled job no longer fits inline once wrapped, the original job is moved into a box from the slab arena so the
+// wrapper itself remains allocation free
+auto Scheduler::WorkerPool::sample_queue_latency(Job& job) -> void {
+    if constexpr (metrics_enabled) {
+        thread_local auto countdown = uint32_t(0);
+        if (countdown > 0) {
+            countdown -= 1;
+            return;
         }
+
+        countdown = queue_latency_sample_period - 1;
+        auto boxed = SlabJobBox(::new (SlabArena::allocate(sizeof(Job))) Job(std::move(job)));
+        job = [this, boxed = std::move(boxed), queued_at = std::chrono::steady_clock::now()](Context ctx) {
+            if (ctx.worker_id.has_value() && ctx.worker_id.value() < workers.size()) {
+                auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - queued_at);
+                workers[ctx.worker_id.value()]->counters().queue_latency.record(static_cast<uint64_t>(latency.count()));
+            }
+
+            (*boxed)(ctx);
+        };
     }
 }
 
+auto Scheduler::WorkerPool::help_until(const std::function<bool()>& done) -> bool {
+    auto* worker = JobWorker::current();
+    if (worker == nullptr || &worker->owner() != this) { return false; }
 
-auto Scheduler::WorkerPool::find_new_work() -> std::optional<Job> {
-    // check the global queue for any jobs
-    if (auto job = global_queue.dequeue(); job.has_value()) {
-        return job;
+    worker->help_until(done);
+    return true;
+}
+
+// wake_helpers has no way to single out the helpers amongst the parked workers, it wakes them all and the workers that
+// were simply idle park again
+auto Scheduler::WorkerPool::wake_helpers() -> void { idle_workers.notify_all(); }
+
+auto Scheduler::WorkerPool::has_idle_pollers() const -> bool {
+    return poll_group != nullptr && searching_workers.load(std::memory_order_relaxed) > 0;
+}
+
+auto Scheduler::WorkerPool::poll_idle(Context ctx) -> void {
+    if (poll_group == nullptr || !poll_group->needs_poll(std::chrono::steady_clock::now())) { return; }
+
+    static_cast<void>(poll_group->try_poll([this, ctx](std::vector<Job> jobs) {
+        queue(ctx.with_priority(Priority::Latency), std::move(jobs));
+    }));
+}
+
+auto Scheduler::WorkerPool::start_searching() -> void { searching_workers.fetch_add(1, std::memory_order_seq_cst); }
+auto Scheduler::WorkerPool::stop_searching(bool found_work) -> void {
+    auto was_last_searcher = searching_workers.fetch_sub(1, std::memory_order_seq_cst) == 1;
+    if (found_work && was_last_searcher) {
+        idle_workers.notify(1);
+    }
+}
+
+auto Scheduler::WorkerPool::park(JobWorker& worker, const std::stop_token& stop_token) -> bool {
+    auto key = idle_workers.prepare_wait();
+    if (stop_token.stop_requested() || has_work(worker)) {
+        idle_workers.cancel_wait();
+        return true;
+    }
+
+    worker.counters().parks.increment();
+    if (!is_elastic()) {
+        idle_workers.wait(key);
+        return true;
+    }
+
+    return idle_workers.wait_for(key, idle_worker_timeout) || !try_retire(worker);
+}
+
+auto Scheduler::WorkerPool::park_helper(JobWorker& worker, const std::function<bool()>& done) -> void {
+    auto key = idle_workers.prepare_wait();
+    if (done() || has_work(worker)) {
+        idle_workers.cancel_wait();
+        return;
+    }
+
+    worker.counters().parks.increment();
+    idle_workers.wait(key);
+}
+
+// try_retire gives up the worker's place in the pool, a job queued as the worker timed out may have counted the worker
+// as a waiter and hence woken nobody, so once the worker is no longer counted it re-checks the queues before retiring
+auto Scheduler::WorkerPool::try_retire(const JobWorker& worker) -> bool {
+    auto running = running_workers.load(std::memory_order_relaxed);
+    do {
+        if (running <= min_workers) { return false; }
+    } while (!running_workers.compare_exchange_weak(running, running - 1, std::memory_order_seq_cst));
+
+    if (has_work(worker)) {
+        running_workers.fetch_add(1, std::memory_order_relaxed);
+        return false;
     }
 
-    // we must now evict a job from another worker queue, we do this by from some random worker
-    // until we wrap around, we do this "approximately" skipping if we see no jobs
-    auto ran_dev = std::random_device();
-    auto mersene = std::mt19937(ran_dev());
-    auto dist = std::uniform_int_distribution<int>(0, static_cast<int>(workers.size()) - 1);
+    return true;
+}
 
-    auto num_workers = workers.size();
-    auto random_worker = static_cast<size_t>(dist(mersene));
+auto Scheduler::WorkerPool::supervise(const std::stop_token& stop_token) -> void {
+    auto wake_on_stop = std::stop_callback(stop_token, [this]() { pressure.notify_all(); });
+    while (!stop_token.stop_requested()) {
+        auto key = pressure.prepare_wait();
+        if (stop_token.stop_requested() || is_saturated()) {
+            pressure.cancel_wait();
+        } else {
+            static_cast<void>(pressure.wait_for(key, supervise_interval));
+            continue;
+        }
 
-    for (size_t i = 0; i < num_workers; i++) {
-        auto worker_id = (random_worker + i) % num_workers;
-        if (auto job = workers[worker_id].steal_job(); job.has_value()) {
-            return job;
+        // a deep enough queue starts a worker straight away, otherwise the pool must remain saturated for grow_after
+        if (pending_jobs() < grow_queue_depth * running_workers.load(std::memory_order_relaxed)) {
+            std::this_thread::sleep_for(grow_after);
+            if (stop_token.stop_requested() || !is_saturated()) { continue; }
         }
+
+        start_worker();
     }
+}
 
+// start_worker starts the first slot that is not running, a slot that was just retired may still be running down
+// in which case another slot is chosen (or none is started and the supervisor tries again)
+auto Scheduler::WorkerPool::start_worker() -> void {
+    for (auto& worker : workers) {
+        if (!worker->is_running() && worker->start()) {
+            running_workers.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+}
+
+// the pool is saturated when jobs are queued but no worker is looking for them, every running worker is busy
+auto Scheduler::WorkerPool::is_saturated() const -> bool {
+    return searching_workers.load(std::memory_order_relaxed) == 0 && idle_workers.waiters() == 0 && pending_jobs() > 0;
+}
+
+auto Scheduler::WorkerPool::pending_jobs() const -> size_t {
+    auto pending = size_t(0);
+    for (const auto& queue : global_queues) { pending += queue.size(); }
+    for (const auto& worker : workers) { pending += worker->queue_size(); }
+    return pending;
+}
+
+auto Scheduler::WorkerPool::has_work(const JobWorker& worker) const -> bool {
+    auto global_has_work = std::ranges::any_of(global_queues, [](const auto& queue) { return queue.size() > 0; });
+    if (worker.queue_size() > 0 || global_has_work) {
+        return true;
+    }
+
+    return std::ranges::any_of(workers, [](const auto& other) { return other->queue_size() > 0; });
+}
+
+auto Scheduler::WorkerPool::notify_workers(size_t n) -> void {
+    // pairs with the seq_cst decrement in stop_searching, either a worker that stops searching (and then parks) observes
+    // the queued jobs or we observe that it is no longer searching and wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto searching = searching_workers.load(std::memory_order_seq_cst);
+    if (n <= searching) {
+        return;
+    }
+
+    // with no parked worker left to wake the pool may be saturated, the supervisor decides whether to grow it
+    if (is_elastic() && idle_workers.waiters() == 0) { pressure.notify(1); }
+    idle_workers.notify(static_cast<uint32_t>(std::min<size_t>(n - searching, workers.size())));
+}
+
+
+auto Scheduler::WorkerPool::take_global(JobWorker& thief, Priority priority) -> std::optional<Job> {
+    // we take a fair share of the global queue (at most max_global_batch jobs) run the first job and place the remainder
+    // on the thief's queue. The batch is pushed in reverse as the thief pops from its queue in LIFO order, this preserves
+    // the FIFO order of the global queue
+    auto& queue = global_queue(priority);
+    if (queue.size() == 0) { return std::nullopt; }
+
+    thread_local auto batch = std::vector<Job>();
+    auto batch_size = std::min(queue.size() / std::max(active_workers(), 1u) + 1, max_global_batch);
+    if (queue.try_dequeue_bulk(std::back_inserter(batch), batch_size) == 0) {
+        return std::nullopt;
+    }
+
+    auto job = std::optional(std::move(batch.front()));
+    auto surplus = std::span(batch).subspan(1);
+    std::ranges::reverse(surplus);
+    thief.queue(priority, surplus);
+
+    batch.clear();
+    return job;
+}
+
+auto Scheduler::WorkerPool::steal_work(JobWorker& thief, Priority priority) -> std::optional<Job> {
+    // we must now steal from another worker, within each tier we start at some random victim and wrap around until a steal
+    // succeeds, the victim is chosen using the thief's own xorshift generator as this is on the idle path of every worker
+    auto random = static_cast<size_t>(thief.next_random());
+    for (auto level = size_t(0); level < num_steal_tiers; level++) {
+        auto tier = static_cast<StealTier>(level);
+        auto victims = thief.victims(tier);
+        for (size_t i = 0; i < victims.size(); i++) {
+            auto* victim = victims[(random + i) % victims.size()];
+            if (!victim->is_running()) { continue; }
+            if (auto job = victim->steal_half(thief, priority, tier); job.has_value()) {
+                return job;
+            }
+        }
+    }
+
+    thief.counters().failed_steals.increment();
     return {};
+}
+
+auto Scheduler::WorkerPool::load_topology(const SchedulerConfig& config) -> std::optional<Topology> {
+    if (!config.pin_workers) { return std::nullopt; }
+    if (config.topology_file.has_value()) { return Topology::from_file(config.topology_file.value()); }
+    return Topology::discover();
 }
\ No newline at end of file
@@ -1,24 +1,56 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
 #include <vector>
 #include <ranges>
+#include <algorithm>
 
 
 namespace Timing {
+    // TimerId identifies a scheduled timer so that it may be cancelled. A timer's entry is recycled once the timer
+    // expires or is cancelled and each recycling bumps the entry's generation, hence the id of a timer that is no
+    // longer in the wheel is simply stale and cancelling it does nothing
+    struct TimerId {
+        uint32_t entry;
+        uint32_t generation;
+    };
+
 template <typename Timer>
     class HierarchicalTimingWheel {
     public:
         HierarchicalTimingWheel(std::chrono::milliseconds tick_size, std::vector<size_t> wheel_sizes);
 
         [[nodiscard]] auto advance() -> std::vector<Timer>;
-        auto schedule(std::chrono::milliseconds duration_from_last_advancement, Timer&& timer) -> void;
+        auto schedule(std::chrono::milliseconds duration_from_last_advancement, Timer&& timer) -> TimerId;
+
+        // cancel removes a timer from the wheel in constant time and hands it back, std::nullopt if the timer has already
+        // expired or been cancelled
+        [[nodiscard]] auto cancel(TimerId id) -> std::optional<Timer>;
+
+        // next_expiry is the earliest time at which advance() could return a timer, std::nullopt if the wheel is empty.
+        // Timers in the lowest wheel give an exact answer, timers in any higher wheel only reach the lowest wheel once it
+        // wraps around hence for those the time of the next wrap is returned (the caller then simply asks again)
+        [[nodiscard]] auto next_expiry() const -> std::optional<std::chrono::system_clock::time_point>;
+        [[nodiscard]] auto last_advancement() const -> std::chrono::system_clock::time_point { return last_advancement_time; }
 
     private:
+        constexpr static uint32_t no_entry = std::numeric_limits<uint32_t>::max();
+
         auto load_timers_from_wheel(size_t wheel_num) -> void;
         auto determine_timer_wheel(size_t ticks_since_last_advancement) -> std::tuple<size_t, size_t>;
         auto inline determine_new_bottom_wheel_index(std::chrono::system_clock::time_point now) -> size_t;
 
+        // buckets are intrusive doubly linked lists threaded through the entries, see TimerEntry
+        auto link(uint32_t entry, size_t wheel_num, size_t bucket_index) -> void;
+        auto unlink(uint32_t entry) -> void;
+        [[nodiscard]] auto take_bucket(size_t wheel_num, size_t bucket_index) -> uint32_t;
+        [[nodiscard]] auto allocate_entry(size_t tick_offset_into_bucket, Timer&& timer) -> uint32_t;
+        [[nodiscard]] auto release_entry(uint32_t entry) -> Timer;
+
         // TimerEntry contains a timer + some tick_offset_into_bucket
         // an tick_offset_into_bucket represents the amount of "extra" ticks a timer is scheduled for in a bucket
         // ie. consider the buckets [0, 200), [200, 400) with a tick size of 100ms.
@@ -26,9 +58,21 @@ template <typename Timer>
         // after the bucket for the timer, timer has an tick_offset_into_bucket of 100ms or 1 tick. As timers move between
         // hierarchies their offsets change, offsets purely exist for book-keeping purposes to determine
         // where in the lower heirarchy to place a timer.
+        // Entries live in a single pool and are linked into their bucket by index, an entry records the bucket it is in
+        // so that a cancelled timer can be unlinked without searching for it. Free entries are recycled through a free list.
         struct TimerEntry {
             size_t tick_offset_into_bucket;
-            Timer timer;
+            std::optional<Timer> timer;
+            uint32_t generation;
+            uint32_t prev;
+            uint32_t next;
+            uint32_t wheel_num;
+            size_t bucket_index;
+        };
+
+        struct Bucket {
+            uint32_t head = no_entry;
+            uint32_t tail = no_entry;
         };
 
         // Wheel models an individual wheel within the hierarchical timing wheel.
@@ -39,12 +83,15 @@ template <typename Timer>
             size_t num_buckets;
             size_t ticks_per_bucket;
             size_t curr_bucket_index;
-            std::vector<std::vector<TimerEntry>> buckets;
+            std::vector<Bucket> buckets;
+            size_t num_timers;
         };
 
         std::chrono::milliseconds tick_size;
         std::chrono::system_clock::time_point last_advancement_time;
         std::vector<Wheel> wheels;
+        std::vector<TimerEntry> entries;
+        std::vector<uint32_t> free_entries;
     };
 }
 
@@ -67,7 +114,8 @@ Timing::HierarchicalTimingWheel<Timer>::HierarchicalTimingWheel(std::chrono::mil
             .num_buckets = wheel_size,
             .ticks_per_bucket = total_ticks_in_last_wheel,
             .curr_bucket_index = 0,
-            .buckets = std::vector<std::vector<TimerEntry>>(wheel_size)
+            .buckets = std::vector<Bucket>(wheel_size),
+            .num_timers = 0,
         });
 
         total_ticks_in_last_wheel *= wheel_size;
@@ -79,15 +127,29 @@ Timing::HierarchicalTimingWheel<Timer>::HierarchicalTimingWheel(std::chrono::mil
 
 
 template <typename Timer>
-auto Timing::HierarchicalTimingWheel<Timer>::schedule(std::chrono::milliseconds duration_from_last_advancement, Timer&& timer) -> void {
+auto Timing::HierarchicalTimingWheel<Timer>::schedule(std::chrono::milliseconds duration_from_last_advancement, Timer&& timer) -> TimerId {
     auto ticks_to_fit = static_cast<size_t>(duration_from_last_advancement / tick_size);
 
     auto [wheel_to_place_in, ticks_left] = determine_timer_wheel(ticks_to_fit);
-    auto& [num_buckets, ticks_per_bucket, curr_bucket_index, buckets] = wheels[wheel_to_place_in];
+    auto& [num_buckets, ticks_per_bucket, curr_bucket_index, buckets, _] = wheels[wheel_to_place_in];
 
     auto timer_bucket_index = (curr_bucket_index + (ticks_left / ticks_per_bucket)) % num_buckets;
     auto tick_offset_into_bucket = ticks_left % ticks_per_bucket;
-    buckets[timer_bucket_index].push_back(TimerEntry { tick_offset_into_bucket, std::move(timer) });
+    auto entry = allocate_entry(tick_offset_into_bucket, std::move(timer));
+    link(entry, wheel_to_place_in, timer_bucket_index);
+    return { entry, entries[entry].generation };
+}
+
+
+template <typename Timer>
+auto Timing::HierarchicalTimingWheel<Timer>::cancel(TimerId id) -> std::optional<Timer> {
+    if (id.entry >= entries.size()) { return std::nullopt; }
+
+    auto& entry = entries[id.entry];
+    if (entry.generation != id.generation || !entry.timer.has_value()) { return std::nullopt; }
+
+    unlink(id.entry);
+    return release_entry(id.entry);
 }
 
 
@@ -97,17 +159,21 @@ auto Timing::HierarchicalTimingWheel<Timer>::advance() -> std::vector<Timer> {
     if (now - last_advancement_time < tick_size) { return std::vector<Timer>(); }
             
     auto resolved_timers = std::vector<Timer>();
-    auto& [lowest_wheel_size, _, lowest_wheel_bucket_index, lowest_wheel] = wheels[0];
-    auto completed_buckets = std::views::iota(lowest_wheel_bucket_index, determine_new_bottom_wheel_index(now))
-                           | std::views::transform([lowest_wheel_size=lowest_wheel_size](auto bucket) { return bucket % lowest_wheel_size; });
+    auto lowest_wheel_size = wheels[0].num_buckets;
+    auto completed_buckets = std::views::iota(wheels[0].curr_bucket_index, determine_new_bottom_wheel_index(now))
+                           | std::views::transform([lowest_wheel_size](auto bucket) { return bucket % lowest_wheel_size; });
 
     // keep reading all the timers from each bucket until we reach the current time
     for (auto bucket : completed_buckets) {
-        for (auto& [_, timer] : lowest_wheel[bucket]) { resolved_timers.push_back(std::move(timer)); }
-
-        // clear this bucket and advance the current bucket index
-        // to the next bucket, if we've wrapped around to 0 we need to load all events from the wheel above us
-        lowest_wheel[bucket].clear();
+        for (auto entry = take_bucket(0, bucket); entry != no_entry;) {
+            auto next = entries[entry].next;
+            resolved_timers.push_back(release_entry(entry));
+            entry = next;
+        }
+
+        // advance the current bucket index to the next bucket, if we've wrapped around to 0
+        // we need to load all events from the wheel above us
+        auto& lowest_wheel_bucket_index = wheels[0].curr_bucket_index;
         lowest_wheel_bucket_index = (lowest_wheel_bucket_index + 1) % lowest_wheel_size;
         if (lowest_wheel_bucket_index == 0) { load_timers_from_wheel(/* wheel_num = */ 1); }
     }
@@ -117,6 +183,22 @@ auto Timing::HierarchicalTimingWheel<Timer>::advance() -> std::vector<Timer> {
 }
 
 
+template <typename Timer>
+auto Timing::HierarchicalTimingWheel<Timer>::next_expiry() const -> std::optional<std::chrono::system_clock::time_point> {
+    // advance() consumes the bucket k places past the current bucket once k + 1 whole ticks have passed
+    const auto& [lowest_wheel_size, _, lowest_wheel_bucket_index, lowest_wheel, __] = wheels[0];
+    for (auto bucket = lowest_wheel_bucket_index; bucket < lowest_wheel_size; bucket++) {
+        if (lowest_wheel[bucket].head != no_entry) {
+            return last_advancement_time + tick_size * static_cast<int64_t>(bucket - lowest_wheel_bucket_index + 1);
+        }
+    }
+
+    auto higher_wheels_empty = std::ranges::all_of(wheels | std::views::drop(1), [](const auto& wheel) { return wheel.num_timers == 0; });
+    if (higher_wheels_empty) { return std::nullopt; }
+    return last_advancement_time + tick_size * static_cast<int64_t>(lowest_wheel_size - lowest_wheel_bucket_index);
+}
+
+
 // load_timers_from_wheel will load all the timers from the wheel at wheel_num into the wheel at wheel_num - 1
 // this is done to ensure that we don't have to iterate through all the wheels to find the timers that need to be executed.
 // During each load it recomputes the "offset" of that timer into this wheel -> that is how many ticks into the bucket the timer is.
@@ -125,20 +207,22 @@ template <typename Timer>
 auto Timing::HierarchicalTimingWheel<Timer>::load_timers_from_wheel(size_t wheel_num) -> void {
     if (wheel_num == wheels.size() || wheel_num == 0) { return; }
 
-    auto& [num_buckets, _, wheel_index, wheel] = wheels[wheel_num];
-    auto& [num_buckets_below, ticks_per_bucket_below, wheel_index_below, wheel_below] = wheels[wheel_num - 1];
+    auto wheel_index = wheels[wheel_num].curr_bucket_index;
+    const auto& [num_buckets_below, ticks_per_bucket_below, wheel_index_below, _, __] = wheels[wheel_num - 1];
 
-    // populate the wheel below wheel_num with the contents of the current wheel_num index
-    for (auto& [tick_offset_into_bucket, timer] : wheel[wheel_index]) {
+    // populate the wheel below wheel_num with the contents of the current wheel_num index, the entries are
+    // relinked rather than moved
+    for (auto entry = take_bucket(wheel_num, wheel_index); entry != no_entry;) {
+        auto next = entries[entry].next;
+        auto& tick_offset_into_bucket = entries[entry].tick_offset_into_bucket;
         auto bucket_index = (wheel_index_below + (tick_offset_into_bucket / ticks_per_bucket_below)) % num_buckets_below;
-        auto new_tick_offset_into_bucket = tick_offset_into_bucket - (bucket_index * ticks_per_bucket_below);
-        wheel_below[bucket_index].push_back(TimerEntry { new_tick_offset_into_bucket, std::move(timer) });
+        tick_offset_into_bucket -= bucket_index * ticks_per_bucket_below;
+        link(entry, wheel_num - 1, bucket_index);
+        entry = next;
     }
 
-    // clear the entry for this wheel's moved bucket
-    wheel[wheel_index].clear();            
-    wheel_index = (wheel_index + 1) % num_buckets;
-    if (wheel_index == 0) { load_timers_from_wheel(wheel_num + 1); }
+    wheels[wheel_num].curr_bucket_index = (wheel_index + 1) % wheels[wheel_num].num_buckets;
+    if (wheels[wheel_num].curr_bucket_index == 0) { load_timers_from_wheel(wheel_num + 1); }
 }
 
 
@@ -164,7 +248,7 @@ auto Timing::HierarchicalTimingWheel<Timer>::determine_timer_wheel(size_t ticks_
     auto can_fit_in_wheel = [&wheels=this->wheels, &ticks_to_fit](auto wheel) {
         if (wheel == wheels.size() - 1) { return true; }
 
-        auto& [num_buckets, ticks_per_bucket, wheel_index, _] = wheels[wheel];
+        auto& [num_buckets, ticks_per_bucket, wheel_index, _, __] = wheels[wheel];
         return wheel_index + (ticks_to_fit / ticks_per_bucket) < num_buckets;
     };
 
@@ -183,4 +267,76 @@ auto inline Timing::HierarchicalTimingWheel<Timer>::determine_new_bottom_wheel_i
     auto& lowest_wheel_bucket_index = wheels[0].curr_bucket_index;
     auto bucket_index = lowest_wheel_bucket_index + static_cast<size_t>((now - last_advancement_time) / tick_size);
     return bucket_index;
-}
\ No newline at end of file
+}
+
+
+template <typename Timer>
+auto Timing::HierarchicalTimingWheel<Timer>::link(uint32_t entry, size_t wheel_num, size_t bucket_index) -> void {
+    auto& wheel = wheels[wheel_num];
+    auto& bucket = wheel.buckets[bucket_index];
+    auto& linked = entries[entry];
+
+    linked.wheel_num = static_cast<uint32_t>(wheel_num);
+    linked.bucket_index = bucket_index;
+    linked.prev = bucket.tail;
+    linked.next = no_entry;
+
+    if (bucket.tail == no_entry) { bucket.head = entry; } else { entries[bucket.tail].next = entry; }
+    bucket.tail = entry;
+    wheel.num_timers += 1;
+}
+
+template <typename Timer>
+auto Timing::HierarchicalTimingWheel<Timer>::unlink(uint32_t entry) -> void {
+    auto& unlinked = entries[entry];
+    auto& wheel = wheels[unlinked.wheel_num];
+    auto& bucket = wheel.buckets[unlinked.bucket_index];
+
+    if (unlinked.prev == no_entry) { bucket.head = unlinked.next; } else { entries[unlinked.prev].next = unlinked.next; }
+    if (unlinked.next == no_entry) { bucket.tail = unlinked.prev; } else { entries[unlinked.next].prev = unlinked.prev; }
+    wheel.num_timers -= 1;
+}
+
+// take_bucket empties a bucket, returning the head of its list. The entries keep their next links so the caller may
+// walk the list, each entry must then be released or relinked
+template <typename Timer>
+auto Timing::HierarchicalTimingWheel<Timer>::take_bucket(size_t wheel_num, size_t bucket_index) -> uint32_t {
+    auto& wheel = wheels[wheel_num];
+    auto& bucket = wheel.buckets[bucket_index];
+    for (auto entry = bucket.head; entry != no_entry; entry = entries[entry].next) { wheel.num_timers -= 1; }
+
+    bucket.tail = no_entry;
+    return std::exchange(bucket.head, no_entry);
+}
+
+template <typename Timer>
+auto Timing::HierarchicalTimingWheel<Timer>::allocate_entry(size_t tick_offset_into_bucket, Timer&& timer) -> uint32_t {
+    if (free_entries.empty()) {
+        entries.push_back(TimerEntry {
+            .tick_offset_into_bucket = tick_offset_into_bucket,
+            .timer = std::optional<Timer>(std::move(timer)),
+            .generation = 0,
+            .prev = no_entry,
+            .next = no_entry,
+            .wheel_num = 0,
+            .bucket_index = 0,
+        });
+        return static_cast<uint32_t>(entries.size() - 1);
+    }
+
+    auto entry = free_entries.back();
+    free_entries.pop_back();
+    entries[entry].tick_offset_into_bucket = tick_offset_into_bucket;
+    entries[entry].timer.emplace(std::move(timer));
+    return entry;
+}
+
+template <typename Timer>
+auto Timing::HierarchicalTimingWheel<Timer>::release_entry(uint32_t entry) -> Timer {
+    auto& released = entries[entry];
+    auto timer = std::move(released.timer.value()); // NOLINT(bugprone-unchecked-optional-access)
+    released.timer.reset();
+    released.generation += 1;
+    free_entries.push_back(entry);
+    return timer;
+}
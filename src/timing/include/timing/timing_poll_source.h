@@ -1,22 +1,37 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <optional>
+
 #include "timing/structures/timing_wheel_hierarchical.h"
 #include "concurrency/spinlock.h"
 #include "scheduler/poll_source.h"
 #include "scheduler/job.h"
 
 namespace Timing {
+    // PollSource is polled only once its earliest timer is due, scheduling a timer that expires before the deadline the
+    // poll thread is currently sleeping towards wakes the poll thread so that it can re-arm for the earlier deadline
     class PollSource : public Scheduler::IPollSource {
     public:
         PollSource();
 
         [[nodiscard]] auto poll_frequency() -> std::chrono::milliseconds override;
         [[nodiscard]] auto poll() -> std::vector<Scheduler::Job> override;
+        [[nodiscard]] auto next_poll() -> std::optional<TimePoint> override;
+        auto attach(Scheduler::IPollWaker* waker) -> void override;
 
-        auto schedule(std::chrono::milliseconds expiry, Scheduler::Job task) -> void;
+        // schedule returns the id of the timer, which may be passed to cancel to remove the timer from the wheel before
+        // it expires. cancel returns false if the timer has already expired (or been cancelled)
+        auto schedule(std::chrono::milliseconds expiry, Scheduler::Job task) -> TimerId;
+        auto cancel(TimerId timer) -> bool;
 
     private:
         SpinLock spinlock;
         HierarchicalTimingWheel<Scheduler::Job> wheel;
+
+        // reported_expiry is the expiry last handed to the poll thread via next_poll, guarded by the spinlock
+        std::optional<std::chrono::system_clock::time_point> reported_expiry;
+        std::atomic<Scheduler::IPollWaker*> waker = { nullptr };
     };
-}
\ No newline at end of file
+}
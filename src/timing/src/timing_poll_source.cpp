@@ -1,4 +1,6 @@
+#include <atomic>
 #include <chrono>
+#include <optional>
 #include <mutex>
 #include <utility>
 #include <vector>
@@ -20,12 +22,48 @@ Timing::PollSource::PollSource() :
             10  // 10 day wheel (we support the scheduling of events max 10 days into the future)
     })) {}
 
-auto Timing::PollSource::schedule(std::chrono::milliseconds expiry, Scheduler::Job task) -> void {
-    const std::lock_guard<SpinLock> lock(spinlock);
-    wheel.schedule(expiry, std::move(task));
+// schedule places the timer relative to the wheel's last advancement, as the poll thread no longer advances the wheel
+// continuously the time since that advancement must be accounted for. The poll thread only needs waking if the timer
+// expires before the expiry it is currently sleeping towards.
+auto Timing::PollSource::schedule(std::chrono::milliseconds expiry, Scheduler::Job task) -> TimerId {
+    auto now = std::chrono::system_clock::now();
+    auto wake_poller = false;
+    auto timer = TimerId {};
+    {
+        const std::lock_guard<SpinLock> lock(spinlock);
+        auto since_advancement = std::chrono::duration_cast<std::chrono::milliseconds>(now - wheel.last_advancement());
+        timer = wheel.schedule(since_advancement + expiry, std::move(task));
+        wake_poller = !reported_expiry.has_value() || now + expiry < reported_expiry.value();
+    }
+
+    if (auto* poller = waker.load(std::memory_order_acquire); wake_poller && poller != nullptr) { poller->wake(); }
+    return timer;
+}
+
+// cancel destroys the cancelled job once the lock is released, the job may well own the last reference to a cell.
+// The poll thread is not woken, at worst it wakes for an expiry that no longer has a timer and simply re-arms
+auto Timing::PollSource::cancel(TimerId timer) -> bool {
+    auto cancelled = std::optional<Scheduler::Job>();
+    {
+        const std::lock_guard<SpinLock> lock(spinlock);
+        cancelled = wheel.cancel(timer);
+    }
+
+    return cancelled.has_value();
 }
 
 auto Timing::PollSource::poll_frequency() -> std::chrono::milliseconds { return std::chrono::milliseconds(5); }
+auto Timing::PollSource::attach(Scheduler::IPollWaker* poller) -> void { waker.store(poller, std::memory_order_release); }
+
+// next_poll translates the wheel's (system clock) expiry onto the poll thread's steady clock
+auto Timing::PollSource::next_poll() -> std::optional<TimePoint> {
+    const std::lock_guard<SpinLock> lock(spinlock);
+    reported_expiry = wheel.next_expiry();
+    if (!reported_expiry.has_value()) { return std::nullopt; }
+
+    auto until_expiry = reported_expiry.value() - std::chrono::system_clock::now();
+    return std::chrono::steady_clock::now() + std::chrono::ceil<std::chrono::steady_clock::duration>(until_expiry);
+}
 auto Timing::PollSource::poll() -> std::vector<Scheduler::Job> {
     // busy wait for the lock - we busy wait as the other thread (schedule) will not maintain
     // the lock for that long so its illogical to yield our time slice